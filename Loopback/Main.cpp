@@ -0,0 +1,38 @@
+
+#include <nstd/Console.h>
+#include <nstd/Process.h>
+
+#include "Server.h"
+
+int_t main(int_t argc, char_t* argv[])
+{
+  String address("127.0.0.1:13211");
+  {
+    Process::Option options[] = {
+        {'h', "help", Process::optionFlag},
+    };
+    Process::Arguments arguments(argc, argv, options);
+    int_t character;
+    String argument;
+    while(arguments.read(character, argument))
+      switch(character)
+      {
+      case 0:
+        address = argument;
+        break;
+      case '?':
+        Console::errorf("Unknown option: %s.\n", (const char_t*)argument);
+        return 1;
+      default:
+        Console::errorf("Usage: %s [<address>]\n", argv[0]);
+        return 1;
+      }
+  }
+
+  Server server;
+  if(!server.listen(address))
+    return Console::errorf("error: Could not listen on %s: %s\n", (const char_t*)address, (const char_t*)server.getLastError()), 1;
+  Console::printf("listening on %s\n", (const char_t*)address);
+  server.run();
+  return 0;
+}
@@ -0,0 +1,323 @@
+
+#include <nstd/Time.h>
+#include <nstd/Memory.h>
+
+#include "Server.h"
+#include "Session.h"
+
+Server::~Server()
+{
+  socket.close();
+  for(List<Session*>::Iterator i = sessions.begin(), end = sessions.end(); i != end; ++i)
+  {
+    (*i)->stop();
+    delete *i;
+  }
+  for(HashMap<uint32_t, Table*>::Iterator i = tables.begin(), end = tables.end(); i != end; ++i)
+    delete *i;
+}
+
+bool_t Server::listen(const String& address)
+{
+  uint16_t port = 13211;
+  uint32_t ip = Socket::inetAddr(address, &port);
+  if(!socket.open() || !socket.setReuseAddress() || !socket.bind(ip, port) || !socket.listen())
+    return error = Socket::getErrorString(), false;
+  tablesTable.id = zlimdb_table_tables;
+  tablesTable.lastId = 0;
+  tablesTable.lastTime = 0;
+  return true;
+}
+
+void_t Server::run()
+{
+  for(;;)
+  {
+    Session* session = new Session(*this);
+    uint32_t ip;
+    uint16_t port;
+    if(!socket.accept(session->getSocket(), ip, port))
+    {
+      delete session;
+      break;
+    }
+    session->getSocket().setNoDelay();
+
+    // sessions of disconnected clients are collected whenever a new one connects
+    mutex.lock();
+    for(List<Session*>::Iterator i = sessions.begin(), end = sessions.end(); i != end;)
+      if((*i)->isFinished())
+      {
+        (*i)->stop();
+        delete *i;
+        i = sessions.remove(i);
+      }
+      else
+        ++i;
+    sessions.append(session);
+    mutex.unlock();
+    if(!session->start())
+    {
+      mutex.lock();
+      sessions.remove(sessions.find(session));
+      mutex.unlock();
+      delete session;
+    }
+  }
+}
+
+Server::Table* Server::findTable(uint32_t tableId)
+{
+  if(tableId == zlimdb_table_tables)
+    return &tablesTable;
+  HashMap<uint32_t, Table*>::Iterator it = tables.find(tableId);
+  return it == tables.end() ? 0 : *it;
+}
+
+Server::Table* Server::addTable(const String& name)
+{
+  Table* table = new Table;
+  table->id = nextTableId++;
+  table->name = name;
+  table->lastId = 0;
+  table->lastTime = 0;
+  tables.append(table->id, table);
+  tableNames.append(name, table->id);
+
+  byte_t buffer[sizeof(zlimdb_table_entity) + ZLIMDB_MAX_MESSAGE_SIZE];
+  zlimdb_table_entity* entity = (zlimdb_table_entity*)buffer;
+  entity->entity.id = table->id;
+  entity->entity.time = Time::time();
+  entity->entity.size = (uint16_t)(sizeof(zlimdb_table_entity) + name.length());
+  entity->name_size = (uint16_t)name.length();
+  Memory::copy(entity + 1, (const char_t*)name, name.length());
+  append(tablesTable, entity->entity);
+  return table;
+}
+
+void_t Server::append(Table& table, const zlimdb_entity& entity)
+{
+  table.offsets.append(table.entities.size());
+  table.entities.append((const byte_t*)&entity, entity.size);
+  table.lastId = entity.id;
+  table.lastTime = entity.time;
+
+  zlimdb_add_request addRequest;
+  addRequest.header.flags = 0;
+  addRequest.header.message_type = zlimdb_message_add_request;
+  addRequest.header.request_id = 0;
+  addRequest.table_id = table.id;
+  for(List<Session*>::Iterator i = table.subscribers.begin(), end = table.subscribers.end(); i != end; ++i)
+    (*i)->send(addRequest.header, sizeof(addRequest), &entity, entity.size);
+}
+
+bool_t Server::removeSubscriber(Table& table, Session& session)
+{
+  List<Session*>::Iterator it = table.subscribers.find(&session);
+  if(it == table.subscribers.end())
+    return false;
+  table.subscribers.remove(it);
+  return true;
+}
+
+void_t Server::rebuildTablesTable()
+{
+  Buffer entities;
+  Array<size_t> offsets;
+  for(Array<size_t>::Iterator i = tablesTable.offsets.begin(), end = tablesTable.offsets.end(); i != end; ++i)
+  {
+    const zlimdb_entity* entity = (const zlimdb_entity*)((const byte_t*)tablesTable.entities + *i);
+    if(!tables.contains((uint32_t)entity->id))
+      continue;
+    offsets.append(entities.size());
+    entities.append((const byte_t*)entity, entity->size);
+  }
+  tablesTable.entities.swap(entities);
+  tablesTable.offsets.swap(offsets);
+}
+
+uint16_t Server::createTable(const String& name, uint32_t& tableId)
+{
+  if(name.isEmpty() || name.length() > ZLIMDB_MAX_MESSAGE_SIZE - sizeof(zlimdb_add_request) - sizeof(zlimdb_table_entity))
+    return zlimdb_error_invalid_message_data;
+  mutex.lock();
+  if(tableNames.contains(name))
+    return mutex.unlock(), zlimdb_error_table_already_exists;
+  tableId = addTable(name)->id;
+  mutex.unlock();
+  return zlimdb_error_none;
+}
+
+uint16_t Server::copyTable(uint32_t tableId, const String& name, uint32_t& newTableId)
+{
+  mutex.lock();
+  Table* table = findTable(tableId);
+  if(!table || table == &tablesTable)
+    return mutex.unlock(), zlimdb_error_table_not_found;
+  if(tableNames.contains(name))
+    return mutex.unlock(), zlimdb_error_table_already_exists;
+  Table* newTable = addTable(name);
+  newTable->entities = table->entities;
+  newTable->offsets = table->offsets;
+  newTable->lastId = table->lastId;
+  newTable->lastTime = table->lastTime;
+  newTableId = newTable->id;
+  mutex.unlock();
+  return zlimdb_error_none;
+}
+
+uint16_t Server::findTable(const String& name, uint32_t& tableId)
+{
+  mutex.lock();
+  HashMap<String, uint32_t>::Iterator it = tableNames.find(name);
+  if(it == tableNames.end())
+    return mutex.unlock(), zlimdb_error_table_not_found;
+  tableId = *it;
+  mutex.unlock();
+  return zlimdb_error_none;
+}
+
+uint16_t Server::removeTable(uint32_t tableId)
+{
+  mutex.lock();
+  HashMap<uint32_t, Table*>::Iterator it = tables.find(tableId);
+  if(it == tables.end())
+    return mutex.unlock(), zlimdb_error_table_not_found;
+  Table* table = *it;
+  tableNames.remove(table->name);
+  tables.remove(it);
+  delete table;
+  rebuildTablesTable();
+
+  zlimdb_remove_request removeRequest;
+  removeRequest.header.flags = 0;
+  removeRequest.header.message_type = zlimdb_message_remove_request;
+  removeRequest.header.request_id = 0;
+  removeRequest.table_id = zlimdb_table_tables;
+  removeRequest.id = tableId;
+  for(List<Session*>::Iterator i = tablesTable.subscribers.begin(), end = tablesTable.subscribers.end(); i != end; ++i)
+    (*i)->send(removeRequest.header, sizeof(removeRequest));
+  mutex.unlock();
+  return zlimdb_error_none;
+}
+
+uint16_t Server::clearTable(uint32_t tableId)
+{
+  mutex.lock();
+  Table* table = findTable(tableId);
+  if(!table || table == &tablesTable)
+    return mutex.unlock(), zlimdb_error_table_not_found;
+  table->entities.resize(0);
+  table->offsets.clear();
+  mutex.unlock();
+  return zlimdb_error_none;
+}
+
+uint16_t Server::add(uint32_t tableId, const zlimdb_entity& entity, uint64_t& id)
+{
+  if(tableId == zlimdb_table_tables)
+  {
+    // adding to the tables table creates a table
+    const zlimdb_table_entity& tableEntity = (const zlimdb_table_entity&)entity;
+    if(entity.size < sizeof(zlimdb_table_entity) || sizeof(zlimdb_table_entity) + tableEntity.name_size > entity.size)
+      return zlimdb_error_invalid_message_data;
+    uint32_t newTableId;
+    uint16_t result = createTable(String((const char_t*)(&tableEntity + 1), tableEntity.name_size), newTableId);
+    id = newTableId;
+    return result;
+  }
+  mutex.lock();
+  Table* table = findTable(tableId);
+  if(!table)
+    return mutex.unlock(), zlimdb_error_table_not_found;
+  byte_t buffer[ZLIMDB_MAX_MESSAGE_SIZE];
+  zlimdb_entity* newEntity = (zlimdb_entity*)buffer;
+  Memory::copy(newEntity, &entity, entity.size);
+  newEntity->id = id = table->lastId + 1;
+  if(!newEntity->time)
+    newEntity->time = Time::time();
+  append(*table, *newEntity);
+  mutex.unlock();
+  return zlimdb_error_none;
+}
+
+uint16_t Server::query(Session& session, uint32_t requestId, uint32_t tableId, uint8_t type, uint64_t param, bool_t subscribe)
+{
+  mutex.lock();
+  Table* table = findTable(tableId);
+  if(!table)
+    return mutex.unlock(), zlimdb_error_table_not_found;
+
+  // find the first entity with an id after param, ids are increasing within a table
+  size_t first = 0;
+  if(type == zlimdb_query_type_since_id)
+  {
+    size_t high = table->offsets.size();
+    while(first < high)
+    {
+      size_t middle = first + (high - first) / 2;
+      if(((const zlimdb_entity*)((const byte_t*)table->entities + table->offsets[middle]))->id <= param)
+        first = middle + 1;
+      else
+        high = middle;
+    }
+  }
+  else if(type != zlimdb_query_type_all)
+    return mutex.unlock(), zlimdb_error_invalid_request;
+
+  // the response is split into messages of whole entities, all but the last one are flagged as fragments
+  zlimdb_header header;
+  header.message_type = subscribe ? zlimdb_message_subscribe_response : zlimdb_message_query_response;
+  header.request_id = requestId;
+  const byte_t* pos = first < table->offsets.size() ? (const byte_t*)table->entities + table->offsets[first] : 0;
+  const byte_t* end = (const byte_t*)table->entities + table->entities.size();
+  const size_t maxDataSize = ZLIMDB_MAX_MESSAGE_SIZE - sizeof(zlimdb_header);
+  do
+  {
+    const byte_t* blockEnd = pos;
+    while(blockEnd && blockEnd < end && (size_t)(blockEnd + ((const zlimdb_entity*)blockEnd)->size - pos) <= maxDataSize)
+      blockEnd += ((const zlimdb_entity*)blockEnd)->size;
+    header.flags = blockEnd && blockEnd < end ? zlimdb_header_flag_fragmented : 0;
+    if(!session.send(header, sizeof(header), pos, blockEnd - pos))
+      break;
+    pos = blockEnd;
+  } while(pos && pos < end);
+  if(subscribe)
+  {
+    if(table->subscribers.find(&session) == table->subscribers.end())
+      table->subscribers.append(&session);
+  }
+  mutex.unlock();
+  return zlimdb_error_none;
+}
+
+uint16_t Server::unsubscribe(Session& session, uint32_t tableId)
+{
+  mutex.lock();
+  Table* table = findTable(tableId);
+  if(!table || !removeSubscriber(*table, session))
+    return mutex.unlock(), zlimdb_error_subscription_not_found;
+  mutex.unlock();
+  return zlimdb_error_none;
+}
+
+uint16_t Server::sync(uint32_t tableId, int64_t& tableTime, int64_t& serverTime)
+{
+  mutex.lock();
+  Table* table = findTable(tableId);
+  if(!table)
+    return mutex.unlock(), zlimdb_error_table_not_found;
+  serverTime = Time::time();
+  tableTime = table->lastTime ? table->lastTime : serverTime;
+  mutex.unlock();
+  return zlimdb_error_none;
+}
+
+void_t Server::removeSession(Session& session)
+{
+  mutex.lock();
+  removeSubscriber(tablesTable, session);
+  for(HashMap<uint32_t, Table*>::Iterator i = tables.begin(), end = tables.end(); i != end; ++i)
+    removeSubscriber(**i, session);
+  mutex.unlock();
+}
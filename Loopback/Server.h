@@ -0,0 +1,70 @@
+
+#pragma once
+
+#include <nstd/Buffer.h>
+#include <nstd/Array.h>
+#include <nstd/List.h>
+#include <nstd/HashMap.h>
+#include <nstd/Mutex.h>
+#include <nstd/Socket/Socket.h>
+
+#include <zlimdbprotocol.h>
+
+class Session;
+
+class Server
+{
+public:
+  Server() : nextTableId(firstTableId) {}
+  ~Server();
+
+  String getLastError() const {return error;}
+
+  bool_t listen(const String& address);
+  void_t run();
+
+  uint16_t createTable(const String& name, uint32_t& tableId);
+  uint16_t copyTable(uint32_t tableId, const String& name, uint32_t& newTableId);
+  uint16_t findTable(const String& name, uint32_t& tableId);
+  uint16_t removeTable(uint32_t tableId);
+  uint16_t clearTable(uint32_t tableId);
+  uint16_t add(uint32_t tableId, const zlimdb_entity& entity, uint64_t& id);
+  uint16_t query(Session& session, uint32_t requestId, uint32_t tableId, uint8_t type, uint64_t param, bool_t subscribe);
+  uint16_t unsubscribe(Session& session, uint32_t tableId);
+  uint16_t sync(uint32_t tableId, int64_t& tableTime, int64_t& serverTime);
+  void_t removeSession(Session& session);
+
+private:
+  enum
+  {
+    firstTableId = 0x100,
+  };
+
+  struct Table
+  {
+    uint32_t id;
+    String name;
+    Buffer entities;
+    Array<size_t> offsets;
+    uint64_t lastId;
+    int64_t lastTime;
+    List<Session*> subscribers;
+  };
+
+private:
+  String error;
+  Socket socket;
+  Mutex mutex;
+  List<Session*> sessions;
+  HashMap<uint32_t, Table*> tables;
+  HashMap<String, uint32_t> tableNames;
+  Table tablesTable; // holds a table entity for each table, so it can be queried and subscribed like any other table
+  uint32_t nextTableId;
+
+private:
+  Table* findTable(uint32_t tableId);
+  Table* addTable(const String& name);
+  void_t append(Table& table, const zlimdb_entity& entity);
+  void_t rebuildTablesTable();
+  static bool_t removeSubscriber(Table& table, Session& session);
+};
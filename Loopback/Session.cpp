@@ -0,0 +1,287 @@
+
+#include <nstd/Memory.h>
+
+#include "Session.h"
+#include "Server.h"
+
+bool_t Session::start()
+{
+  if(!sendThread.start(sendThreadProc, this))
+    return false;
+  if(!thread.start(threadProc, this))
+  {
+    sendMutex.lock();
+    sending = false;
+    sendSignal.set();
+    sendMutex.unlock();
+    sendThread.join();
+    return false;
+  }
+  return true;
+}
+
+void_t Session::stop()
+{
+  socket.close();
+  thread.join();
+}
+
+uint_t Session::threadProc(void_t* param)
+{
+  Session* session = (Session*)param;
+  session->process();
+  session->server.removeSession(*session);
+
+  // the sender writes what is still queued before it stops
+  session->sendMutex.lock();
+  session->sending = false;
+  session->sendSignal.set();
+  session->sendMutex.unlock();
+  session->sendThread.join();
+  session->finished = true;
+  return 0;
+}
+
+uint_t Session::sendThreadProc(void_t* param)
+{
+  Session* session = (Session*)param;
+  session->processOutgoing();
+  return 0;
+}
+
+void_t Session::processOutgoing()
+{
+  Buffer buffer;
+  for(;;)
+  {
+    sendSignal.wait();
+    sendMutex.lock();
+    buffer.swap(outgoing);
+    outgoing.resize(0);
+    bool_t stop = !sending;
+    sendSignal.reset();
+    sendMutex.unlock();
+    for(const byte_t* pos = buffer, * end = pos + buffer.size(); pos < end;)
+    {
+      ssize_t sent = socket.send(pos, end - pos);
+      if(sent <= 0)
+      {
+        // the receiving thread notices the broken connection and ends the session
+        sendMutex.lock();
+        sending = false;
+        sendMutex.unlock();
+        return;
+      }
+      pos += sent;
+    }
+    if(stop)
+      return;
+  }
+}
+
+void_t Session::process()
+{
+  byte_t buffer[ZLIMDB_MAX_MESSAGE_SIZE];
+  const zlimdb_header* header = (const zlimdb_header*)buffer;
+  for(;;)
+  {
+    if(!receive(buffer, sizeof(zlimdb_header)))
+      break;
+    if(header->size < sizeof(zlimdb_header) || header->size > ZLIMDB_MAX_MESSAGE_SIZE)
+    {
+      sendError(header->request_id, zlimdb_error_invalid_message_size);
+      break;
+    }
+    if(!receive(buffer + sizeof(zlimdb_header), header->size - sizeof(zlimdb_header)))
+      break;
+    if(!handleMessage(*header))
+      break;
+  }
+}
+
+bool_t Session::receive(byte_t* data, size_t size)
+{
+  while(size > 0)
+  {
+    ssize_t received = socket.recv(data, size);
+    if(received <= 0)
+      return false;
+    data += received;
+    size -= received;
+  }
+  return true;
+}
+
+bool_t Session::send(zlimdb_header& header, size_t headerSize, const void_t* data, size_t dataSize)
+{
+  // messages are only queued here, so the server can push subscription updates and query responses while it holds its lock
+  header.size = (uint32_t)(headerSize + dataSize);
+  sendMutex.lock();
+  if(!sending)
+    return sendMutex.unlock(), false;
+  if(outgoing.size() + header.size > maxOutgoingSize)
+  {
+    // a client that does not read its messages is disconnected instead of buffering without limit
+    sending = false;
+    sendSignal.set();
+    sendMutex.unlock();
+    socket.close();
+    return false;
+  }
+  outgoing.append((const byte_t*)&header, headerSize);
+  if(dataSize)
+    outgoing.append((const byte_t*)data, dataSize);
+  sendSignal.set();
+  sendMutex.unlock();
+  return true;
+}
+
+bool_t Session::sendResponse(uint16_t messageType, uint32_t requestId)
+{
+  zlimdb_header header;
+  setHeader(header, messageType, requestId);
+  return send(header, sizeof(header));
+}
+
+bool_t Session::sendError(uint32_t requestId, uint16_t error)
+{
+  zlimdb_error_response response;
+  setHeader(response.header, zlimdb_message_error_response, requestId);
+  response.error = error;
+  return send(response.header, sizeof(response));
+}
+
+bool_t Session::handleMessage(const zlimdb_header& header)
+{
+  uint32_t requestId = header.request_id;
+  if(!authenticated)
+  {
+    // any password is accepted, the salts are sent only to complete the handshake of the client library
+    switch(header.message_type)
+    {
+    case zlimdb_message_login_request:
+      {
+        const zlimdb_login_request& request = (const zlimdb_login_request&)header;
+        if(header.size < sizeof(request) || sizeof(request) + request.user_name_size > header.size)
+          return sendError(requestId, zlimdb_error_invalid_message_size), false;
+        zlimdb_login_response response;
+        setHeader(response.header, zlimdb_message_login_response, requestId);
+        Memory::zero(response.pw_salt, sizeof(response.pw_salt));
+        Memory::zero(response.auth_salt, sizeof(response.auth_salt));
+        return send(response.header, sizeof(response));
+      }
+    case zlimdb_message_auth_request:
+      if(header.size < sizeof(zlimdb_auth_request))
+        return sendError(requestId, zlimdb_error_invalid_message_size), false;
+      authenticated = true;
+      return sendResponse(zlimdb_message_auth_response, requestId);
+    default:
+      return sendError(requestId, zlimdb_error_invalid_login), false;
+    }
+  }
+
+  uint16_t error = zlimdb_error_invalid_message_size;
+  switch(header.message_type)
+  {
+  case zlimdb_message_add_request:
+    {
+      const zlimdb_add_request& request = (const zlimdb_add_request&)header;
+      const zlimdb_entity* entity = (const zlimdb_entity*)(&request + 1);
+      if(header.size < sizeof(request) + sizeof(zlimdb_entity) || entity->size < sizeof(zlimdb_entity) || sizeof(request) + entity->size > header.size)
+        break;
+      zlimdb_add_response response;
+      if((error = server.add(request.table_id, *entity, response.id)) != zlimdb_error_none)
+        break;
+      setHeader(response.header, zlimdb_message_add_response, requestId);
+      return send(response.header, sizeof(response));
+    }
+  case zlimdb_message_remove_request:
+    {
+      // entities are only removed with their table
+      const zlimdb_remove_request& request = (const zlimdb_remove_request&)header;
+      if(header.size < sizeof(request))
+        break;
+      if(request.table_id != zlimdb_table_tables)
+      {
+        error = zlimdb_error_not_implemented;
+        break;
+      }
+      if((error = server.removeTable((uint32_t)request.id)) != zlimdb_error_none)
+        break;
+      return sendResponse(zlimdb_message_remove_response, requestId);
+    }
+  case zlimdb_message_clear_request:
+    {
+      const zlimdb_clear_request& request = (const zlimdb_clear_request&)header;
+      if(header.size < sizeof(request))
+        break;
+      if((error = server.clearTable(request.table_id)) != zlimdb_error_none)
+        break;
+      return sendResponse(zlimdb_message_clear_response, requestId);
+    }
+  case zlimdb_message_query_request:
+    {
+      const zlimdb_query_request& request = (const zlimdb_query_request&)header;
+      if(header.size < sizeof(request))
+        break;
+      if((error = server.query(*this, requestId, request.table_id, request.type, request.param, false)) != zlimdb_error_none)
+        break;
+      return true;
+    }
+  case zlimdb_message_subscribe_request:
+    {
+      const zlimdb_subscribe_request& request = (const zlimdb_subscribe_request&)header;
+      if(header.size < sizeof(request))
+        break;
+      if((error = server.query(*this, requestId, request.table_id, request.type, request.param, true)) != zlimdb_error_none)
+        break;
+      return true;
+    }
+  case zlimdb_message_unsubscribe_request:
+    {
+      const zlimdb_unsubscribe_request& request = (const zlimdb_unsubscribe_request&)header;
+      if(header.size < sizeof(request))
+        break;
+      if((error = server.unsubscribe(*this, request.table_id)) != zlimdb_error_none)
+        break;
+      return sendResponse(zlimdb_message_unsubscribe_response, requestId);
+    }
+  case zlimdb_message_sync_request:
+    {
+      const zlimdb_sync_request& request = (const zlimdb_sync_request&)header;
+      if(header.size < sizeof(request))
+        break;
+      zlimdb_sync_response response;
+      if((error = server.sync(request.table_id, response.table_time, response.server_time)) != zlimdb_error_none)
+        break;
+      setHeader(response.header, zlimdb_message_sync_response, requestId);
+      return send(response.header, sizeof(response));
+    }
+  case zlimdb_message_find_request:
+    {
+      const zlimdb_find_request& request = (const zlimdb_find_request&)header;
+      if(header.size < sizeof(request) || sizeof(request) + request.name_size > header.size)
+        break;
+      zlimdb_find_response response;
+      if((error = server.findTable(String((const char_t*)(&request + 1), request.name_size), response.id)) != zlimdb_error_none)
+        break;
+      setHeader(response.header, zlimdb_message_find_response, requestId);
+      return send(response.header, sizeof(response));
+    }
+  case zlimdb_message_copy_request:
+    {
+      const zlimdb_copy_request& request = (const zlimdb_copy_request&)header;
+      if(header.size < sizeof(request) || sizeof(request) + request.name_size > header.size)
+        break;
+      zlimdb_copy_response response;
+      if((error = server.copyTable(request.table_id, String((const char_t*)(&request + 1), request.name_size), response.id)) != zlimdb_error_none)
+        break;
+      setHeader(response.header, zlimdb_message_copy_response, requestId);
+      return send(response.header, sizeof(response));
+    }
+  default:
+    error = zlimdb_error_invalid_message_type;
+    break;
+  }
+  return sendError(requestId, error);
+}
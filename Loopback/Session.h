@@ -0,0 +1,62 @@
+
+#pragma once
+
+#include <nstd/Buffer.h>
+#include <nstd/Mutex.h>
+#include <nstd/Signal.h>
+#include <nstd/Thread.h>
+#include <nstd/Socket/Socket.h>
+
+#include <zlimdbprotocol.h>
+
+class Server;
+
+class Session
+{
+public:
+  Session(Server& server) : server(server), authenticated(false), sending(true), finished(false) {}
+
+  Socket& getSocket() {return socket;}
+
+  bool_t start();
+  void_t stop();
+  bool_t isFinished() const {return finished;}
+
+  bool_t send(zlimdb_header& header, size_t headerSize, const void_t* data = 0, size_t dataSize = 0);
+
+private:
+  Server& server;
+  Socket socket;
+  Thread thread;
+  Thread sendThread;
+  Mutex sendMutex;
+  Signal sendSignal;
+  Buffer outgoing;
+  bool_t authenticated;
+  bool_t sending;
+  volatile bool_t finished;
+
+private:
+  enum
+  {
+    maxOutgoingSize = 64 * 1024 * 1024,
+  };
+
+private:
+  static uint_t threadProc(void_t* param);
+  static uint_t sendThreadProc(void_t* param);
+
+  void_t process();
+  void_t processOutgoing();
+  bool_t receive(byte_t* data, size_t size);
+  bool_t handleMessage(const zlimdb_header& header);
+  bool_t sendResponse(uint16_t messageType, uint32_t requestId);
+  bool_t sendError(uint32_t requestId, uint16_t error);
+
+  static void_t setHeader(zlimdb_header& header, uint16_t messageType, uint32_t requestId)
+  {
+    header.flags = 0;
+    header.message_type = messageType;
+    header.request_id = requestId;
+  }
+};
@@ -0,0 +1,370 @@
+
+#include <nstd/Console.h>
+#include <nstd/Time.h>
+#include <nstd/List.h>
+#include <nstd/Memory.h>
+#include <nstd/Error.h>
+#include <nstd/Buffer.h>
+
+#include <zlimdbclient.h>
+
+#include "Tools/ClientProtocol.h"
+#include "Tools/Word.h"
+#include "Benchmark.h"
+
+const char_t* Benchmark::getUsage()
+{
+  return "add|query|since|subscribe|all [size=<n>,...] [batch=<n>,...] [depth=<n>,...] [count=<n>] [table=<num>]";
+}
+
+bool_t Benchmark::parse(const String& spec, uint32_t selectedTable)
+{
+  tableId = selectedTable;
+  List<String> args;
+  Word::split(spec, args);
+  if(args.isEmpty())
+    return error = "Missing workload", false;
+  const String& workload = args.front();
+  if(workload == "add" || workload == "all")
+    workloads.append(addWorkload);
+  if(workload == "query" || workload == "all")
+    workloads.append(queryWorkload);
+  if(workload == "since" || workload == "all")
+    workloads.append(sinceWorkload);
+  if(workload == "subscribe" || workload == "all")
+    workloads.append(subscribeWorkload);
+  if(workloads.isEmpty())
+    return error = String("Unknown workload: ") + workload, false;
+
+  for(List<String>::Iterator i = ++args.begin(), end = args.end(); i != end; ++i)
+  {
+    const char_t* assign = i->find('=');
+    if(!assign)
+      return error = String("Invalid argument: ") + *i, false;
+    String key = i->substr(0, assign - (const char_t*)*i);
+    String value = i->substr(assign - (const char_t*)*i + 1);
+    bool_t result = true;
+    if(key == "size")
+      result = parseList(value, payloadSizes);
+    else if(key == "batch")
+      result = parseList(value, batchSizes);
+    else if(key == "depth")
+      result = parseList(value, depths);
+    else if(key == "count")
+      result = (count = value.toUInt()) != 0;
+    else if(key == "table")
+      tableId = value.toUInt();
+    else
+      return error = String("Unknown argument: ") + key, false;
+    if(!result)
+      return error = String("Invalid argument: ") + *i, false;
+  }
+  if(payloadSizes.isEmpty())
+    payloadSizes.append(100);
+  if(batchSizes.isEmpty())
+    batchSizes.append(1);
+  if(depths.isEmpty())
+    depths.append(1);
+  for(Array<uint_t>::Iterator i = payloadSizes.begin(), end = payloadSizes.end(); i != end; ++i)
+    if(*i < sizeof(int64_t) || *i > ZLIMDB_MAX_MESSAGE_SIZE - sizeof(zlimdb_add_request) - sizeof(zlimdb_entity))
+      return error = "Invalid payload size", false;
+  if(!tableId)
+    return error = "No table selected", false;
+  return true;
+}
+
+bool_t Benchmark::parseList(const String& value, Array<uint_t>& result)
+{
+  const char_t* start = value;
+  for(const char_t* str = start;; ++str)
+    if(*str == ',' || !*str)
+    {
+      uint_t number = value.substr(start - (const char_t*)value, str - start).toUInt();
+      if(number == 0)
+        return false;
+      result.append(number);
+      if(!*str)
+        return true;
+      start = str + 1;
+    }
+}
+
+const char_t* Benchmark::getWorkloadName(Workload workload)
+{
+  switch(workload)
+  {
+  case addWorkload: return "add";
+  case queryWorkload: return "query";
+  case sinceWorkload: return "since";
+  case subscribeWorkload: return "subscribe";
+  }
+  return "";
+}
+
+bool_t Benchmark::run()
+{
+  Console::printf("%-9s %6s %6s %6s %10s %12s %12s %10s %8s %8s %8s\n", "workload", "size", "batch", "depth", "ops", "ops/s", "entities/s", "MB/s", "p50 us", "p99 us", "p999 us");
+  for(Array<Workload>::Iterator i = workloads.begin(), end = workloads.end(); i != end; ++i)
+  {
+    // queries do not send payload, and a full query does not have a batch size
+    bool_t variablePayload = *i == addWorkload || *i == subscribeWorkload;
+    bool_t variableBatch = *i != queryWorkload;
+    for(size_t j = 0, payloadCount = variablePayload ? payloadSizes.size() : 1; j < payloadCount; ++j)
+      for(size_t k = 0, batchCount = variableBatch ? batchSizes.size() : 1; k < batchCount; ++k)
+        for(size_t l = 0; l < depths.size(); ++l)
+        {
+          Config config = {*i, variablePayload ? payloadSizes[j] : 0, variableBatch ? batchSizes[k] : 0, depths[l]};
+          if(!run(config))
+            return false;
+        }
+  }
+  return true;
+}
+
+bool_t Benchmark::findLastId(uint64_t& lastId)
+{
+  Connection connection;
+  if(!connection.open(userName, password, address))
+    return error = connection.getLastError(), false;
+  lastId = 0;
+  if(zlimdb_query(connection, tableId, zlimdb_query_type_all, 0) != 0)
+    return error = Connection::getZlimdbError(), false;
+  char_t buffer[ZLIMDB_MAX_MESSAGE_SIZE];
+  while(zlimdb_get_response(connection, (zlimdb_header*)buffer, ZLIMDB_MAX_MESSAGE_SIZE) == 0)
+    for(const zlimdb_entity* entity = zlimdb_get_first_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity));
+        entity;
+        entity = zlimdb_get_next_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity), entity))
+      lastId = entity->id;
+  if(zlimdb_errno() != zlimdb_local_error_none)
+    return error = Connection::getZlimdbError(), false;
+  return true;
+}
+
+bool_t Benchmark::run(const Config& config)
+{
+  uint64_t lastId = 0;
+  if(config.workload == sinceWorkload && !findLastId(lastId))
+    return false;
+
+  Array<Worker*> workers;
+  workers.reserve(config.depth + 1);
+  uint_t workerCount = config.workload == subscribeWorkload ? config.depth + 1 : config.depth;
+  for(uint_t i = 0; i < workerCount; ++i)
+  {
+    Worker* worker = new Worker;
+    worker->benchmark = this;
+    worker->config = &config;
+    worker->operations = worker->entities = worker->bytes = 0;
+    worker->lastId = lastId;
+    worker->index = i;
+    workers.append(worker);
+    bool_t result = i == config.depth ? worker->connection.open(userName, password, address, Worker::zlimdbCallback, worker) :
+                                        worker->connection.open(userName, password, address);
+    if(!result)
+    {
+      error = worker->connection.getLastError();
+      for(Array<Worker*>::Iterator i = workers.begin(), end = workers.end(); i != end; ++i)
+        delete *i;
+      return false;
+    }
+  }
+
+  int64_t startTime = Time::microTicks();
+  if(config.workload == subscribeWorkload)
+  {
+    // the subscription has to be in place before the first entity is added, or the producers' entities would be missed
+    Worker* subscriber = workers[config.depth];
+    if(!subscriber->thread.start(Worker::threadProc, subscriber))
+      subscriber->error = Error::getErrorString();
+    else
+      subscribed.wait();
+    if(!subscriber->error.isEmpty())
+    {
+      subscriber->thread.join();
+      error = subscriber->error;
+      for(Array<Worker*>::Iterator i = workers.begin(), end = workers.end(); i != end; ++i)
+        delete *i;
+      return false;
+    }
+    startTime = Time::microTicks();
+  }
+  for(Array<Worker*>::Iterator i = workers.begin(), end = workers.end(); i != end; ++i)
+    if(config.workload != subscribeWorkload || (*i)->index != config.depth)
+      if(!(*i)->thread.start(Worker::threadProc, *i))
+        (*i)->error = Error::getErrorString();
+  Histogram histogram;
+  uint64_t operations = 0, entities = 0, bytes = 0;
+  for(Array<Worker*>::Iterator i = workers.begin(), end = workers.end(); i != end; ++i)
+  {
+    Worker* worker = *i;
+    worker->thread.join();
+    if(!worker->error.isEmpty())
+      error = worker->error;
+    if(config.workload == subscribeWorkload && worker->index != config.depth)
+      continue; // only the subscriber measures the end-to-end latency
+    histogram.merge(worker->histogram);
+    operations += worker->operations;
+    entities += worker->entities;
+    bytes += worker->bytes;
+  }
+  double duration = (double)(Time::microTicks() - startTime) / 1000000.;
+  if(duration <= 0.)
+    duration = 0.000001;
+  for(Array<Worker*>::Iterator i = workers.begin(), end = workers.end(); i != end; ++i)
+    delete *i;
+  if(!error.isEmpty())
+    return false;
+
+  Console::printf("%-9s %6u %6u %6u %10llu %12.0f %12.0f %10.2f %8llu %8llu %8llu\n", getWorkloadName(config.workload),
+    config.payloadSize, config.batchSize, config.depth, operations, (double)operations / duration, (double)entities / duration,
+    (double)bytes / duration / (1024. * 1024.), histogram.getPercentile(50.), histogram.getPercentile(99.), histogram.getPercentile(99.9));
+  return true;
+}
+
+uint_t Benchmark::Worker::threadProc(void_t* param)
+{
+  Worker* worker = (Worker*)param;
+  switch(worker->config->workload)
+  {
+  case addWorkload:
+    return worker->runAdd();
+  case queryWorkload:
+  case sinceWorkload:
+    return worker->runQuery();
+  case subscribeWorkload:
+    return worker->index == worker->config->depth ? worker->runSubscribe() : worker->runAdd();
+  }
+  return 0;
+}
+
+uint_t Benchmark::Worker::runAdd()
+{
+  const Config& config = *this->config;
+  Buffer buffer;
+  buffer.resize(sizeof(zlimdb_entity) + config.payloadSize);
+  Memory::fill((byte_t*)buffer, 'a', buffer.size());
+  zlimdb_entity* entity = (zlimdb_entity*)(byte_t*)buffer;
+  uint32_t tableId = benchmark->tableId;
+  uint_t total = benchmark->count / config.depth + (index < benchmark->count % config.depth ? 1 : 0);
+  while(entities < total)
+  {
+    uint_t batchSize = config.batchSize;
+    if(entities + batchSize > total)
+      batchSize = (uint_t)(total - entities);
+    int64_t start = Time::microTicks();
+    for(uint_t i = 0; i < batchSize; ++i)
+    {
+      int64_t now = Time::microTicks();
+      ClientProtocol::setEntityHeader(*entity, 0, now / 1000, (uint16_t)buffer.size());
+      Memory::copy(entity + 1, &now, sizeof(now));
+      uint64_t id;
+      if(zlimdb_add(connection, tableId, entity, &id) != 0)
+        return error = Connection::getZlimdbError(), 1;
+    }
+    histogram.add(Time::microTicks() - start);
+    ++operations;
+    entities += batchSize;
+    bytes += batchSize * buffer.size();
+  }
+  return 0;
+}
+
+uint_t Benchmark::Worker::runQuery()
+{
+  const Config& config = *this->config;
+  uint32_t tableId = benchmark->tableId;
+  zlimdb_query_type queryType = config.workload == sinceWorkload ? zlimdb_query_type_since_id : zlimdb_query_type_all;
+  uint64_t param = lastId > config.batchSize ? lastId - config.batchSize : 0;
+  uint_t total = benchmark->count / config.depth + (index < benchmark->count % config.depth ? 1 : 0);
+  if(config.workload == queryWorkload && total > 100)
+    total = 100; // full table scans are expensive, a few of them are enough to get stable numbers
+  char_t buffer[ZLIMDB_MAX_MESSAGE_SIZE];
+  for(uint_t i = 0; i < total; ++i)
+  {
+    int64_t start = Time::microTicks();
+    if(zlimdb_query(connection, tableId, queryType, param) != 0)
+      return error = Connection::getZlimdbError(), 1;
+    while(zlimdb_get_response(connection, (zlimdb_header*)buffer, ZLIMDB_MAX_MESSAGE_SIZE) == 0)
+    {
+      bytes += ((const zlimdb_header*)buffer)->size;
+      for(const zlimdb_entity* entity = zlimdb_get_first_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity));
+          entity;
+          entity = zlimdb_get_next_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity), entity))
+        ++entities;
+    }
+    if(zlimdb_errno() != zlimdb_local_error_none)
+      return error = Connection::getZlimdbError(), 1;
+    histogram.add(Time::microTicks() - start);
+    ++operations;
+  }
+  return 0;
+}
+
+uint_t Benchmark::Worker::runSubscribe()
+{
+  // subscribe to new entities only and measure the time from the producer's zlimdb_add to the arrival of the update
+  bool_t result = subscribe();
+  benchmark->subscribed.signal(); // the producers are started once the subscription is in place
+  if(!result)
+    return 1;
+
+  int64_t lastUpdate = Time::ticks();
+  uint64_t lastEntities = 0;
+  while(entities < benchmark->count)
+  {
+    if(zlimdb_exec(connection, 100) != 0 && zlimdb_errno() != zlimdb_local_error_timeout)
+      return error = Connection::getZlimdbError(), 1;
+    if(entities != lastEntities)
+    {
+      lastEntities = entities;
+      lastUpdate = Time::ticks();
+    }
+    else if(Time::ticks() - lastUpdate > 10000)
+      return error = "Timeout while waiting for updates", 1;
+  }
+  operations = entities;
+  return 0;
+}
+
+bool_t Benchmark::Worker::subscribe()
+{
+  uint32_t tableId = benchmark->tableId;
+  Buffer buffer;
+  buffer.resize(sizeof(zlimdb_entity) + sizeof(int64_t));
+  zlimdb_entity* entity = (zlimdb_entity*)(byte_t*)buffer;
+  ClientProtocol::setEntityHeader(*entity, 0, Time::time(), (uint16_t)buffer.size());
+  Memory::zero(entity + 1, sizeof(int64_t));
+  uint64_t id;
+  if(zlimdb_add(connection, tableId, entity, &id) != 0)
+    return error = Connection::getZlimdbError(), false;
+  if(zlimdb_subscribe(connection, tableId, zlimdb_query_type_since_id, id, zlimdb_subscribe_flag_none) != 0)
+    return error = Connection::getZlimdbError(), false;
+  char_t message[ZLIMDB_MAX_MESSAGE_SIZE];
+  while(zlimdb_get_response(connection, (zlimdb_header*)message, ZLIMDB_MAX_MESSAGE_SIZE) == 0)
+    for(const zlimdb_entity* entity = zlimdb_get_first_entity((zlimdb_header*)message, sizeof(zlimdb_entity));
+        entity;
+        entity = zlimdb_get_next_entity((zlimdb_header*)message, sizeof(zlimdb_entity), entity))
+      countUpdate(entity);
+  if(zlimdb_errno() != zlimdb_local_error_none)
+    return error = Connection::getZlimdbError(), false;
+  return true;
+}
+
+void_t Benchmark::Worker::zlimdbCallback(const void_t* data)
+{
+  const zlimdb_header* header = (const zlimdb_header*)data;
+  if(header->message_type != zlimdb_message_add_request || header->size < sizeof(zlimdb_add_request) + sizeof(zlimdb_entity) + sizeof(int64_t))
+    return;
+  countUpdate((const zlimdb_entity*)((const zlimdb_add_request*)header + 1));
+}
+
+void_t Benchmark::Worker::countUpdate(const zlimdb_entity* entity)
+{
+  if(entity->size < sizeof(zlimdb_entity) + sizeof(int64_t))
+    return;
+  int64_t sent;
+  Memory::copy(&sent, entity + 1, sizeof(sent));
+  histogram.add(Time::microTicks() - sent);
+  ++entities;
+  bytes += entity->size;
+}
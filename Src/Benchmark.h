@@ -0,0 +1,90 @@
+
+#pragma once
+
+#include <nstd/Thread.h>
+#include <nstd/Semaphore.h>
+#include <nstd/Array.h>
+
+#include <zlimdbprotocol.h>
+
+#include "Tools/Histogram.h"
+#include "Connection.h"
+
+class Benchmark
+{
+public:
+  Benchmark(const String& userName, const String& password, const String& address) : userName(userName), password(password), address(address), tableId(0), count(10000) {}
+
+  String getLastError() const {return error;}
+
+  bool_t parse(const String& spec, uint32_t selectedTable);
+
+  bool_t run();
+
+  static const char_t* getUsage();
+
+private:
+  enum Workload
+  {
+    addWorkload,
+    queryWorkload,
+    sinceWorkload,
+    subscribeWorkload,
+  };
+
+  struct Config
+  {
+    Workload workload;
+    uint_t payloadSize;
+    uint_t batchSize;
+    uint_t depth;
+  };
+
+  class Worker
+  {
+  public:
+    Benchmark* benchmark;
+    const Config* config;
+    Connection connection;
+    Thread thread;
+    uint64_t operations;
+    uint64_t entities;
+    uint64_t bytes;
+    uint64_t lastId;
+    uint_t index;
+    Histogram histogram;
+    String error;
+
+  public:
+    static uint_t threadProc(void_t* param);
+    static void_t zlimdbCallback(void_t* userData, const void_t* data) {((Worker*)userData)->zlimdbCallback(data);}
+
+  private:
+    uint_t runAdd();
+    uint_t runQuery();
+    uint_t runSubscribe();
+    bool_t subscribe();
+    void_t zlimdbCallback(const void_t* data);
+    void_t countUpdate(const zlimdb_entity* entity);
+  };
+
+private:
+  const String userName;
+  const String password;
+  const String address;
+  String error;
+  uint32_t tableId;
+  uint_t count;
+  Array<Workload> workloads;
+  Array<uint_t> payloadSizes;
+  Array<uint_t> batchSizes;
+  Array<uint_t> depths;
+  Semaphore subscribed;
+
+private:
+  bool_t run(const Config& config);
+  bool_t findLastId(uint64_t& lastId);
+
+  static bool_t parseList(const String& value, Array<uint_t>& result);
+  static const char_t* getWorkloadName(Workload workload);
+};
@@ -0,0 +1,254 @@
+
+#include <nstd/Memory.h>
+#include <nstd/Error.h>
+
+#include <zlimdbclient.h>
+
+#include "Tools/ClientProtocol.h"
+
+#include "BulkAdder.h"
+
+BulkAdder::BulkAdder() : tableId(0), currentBatch(0), entityCount(0), byteCount(0), aborted(false) {}
+
+BulkAdder::~BulkAdder()
+{
+  stop();
+}
+
+size_t BulkAdder::getMaxDataSize()
+{
+  return ZLIMDB_MAX_MESSAGE_SIZE - sizeof(zlimdb_add_request) - sizeof(zlimdb_entity);
+}
+
+bool_t BulkAdder::start(const String& userName, const String& password, const String& address, uint32_t tableId, uint_t connections)
+{
+  stop();
+  this->tableId = tableId;
+  aborted = false;
+  entityCount = 0;
+  byteCount = 0;
+  if(connections == 0)
+    connections = 1;
+
+  // every sender works on one batch while the reader fills another one, so two batches per sender keep all connections busy
+  // without letting the amount of buffered data grow beyond a fixed bound
+  for(uint_t i = 0; i < connections * 2; ++i)
+  {
+    Batch* batch = new Batch;
+    batch->data.reserve(batchSize);
+    batch->count = 0;
+    batches.append(batch);
+    pushFreeBatch(batch);
+  }
+
+  for(uint_t i = 0; i < connections; ++i)
+  {
+    Sender* sender = new Sender;
+    sender->adder = this;
+    sender->failedCount = 0;
+    sender->failed = false;
+    senders.append(sender);
+    if(!sender->connection.open(userName, password, address))
+    {
+      error = sender->connection.getLastError();
+      stop();
+      return false;
+    }
+  }
+  for(Array<Sender*>::Iterator i = senders.begin(), end = senders.end(); i != end; ++i)
+    if(!(*i)->thread.start(Sender::threadProc, *i))
+    {
+      error = Error::getErrorString();
+      stop();
+      return false;
+    }
+  return true;
+}
+
+bool_t BulkAdder::add(const void_t* data, size_t size, uint64_t time)
+{
+  zlimdb_entity* entity = reserve(sizeof(zlimdb_entity) + size);
+  if(!entity)
+    return false;
+  ClientProtocol::setEntityHeader(*entity, 0, time, sizeof(zlimdb_entity) + size);
+  Memory::copy(entity + 1, data, size);
+  return true;
+}
+
+bool_t BulkAdder::add(const zlimdb_entity& entity)
+{
+  zlimdb_entity* copy = reserve(entity.size);
+  if(!copy)
+    return false;
+  Memory::copy(copy, &entity, entity.size);
+  copy->id = 0;
+  return true;
+}
+
+zlimdb_entity* BulkAdder::reserve(size_t size)
+{
+  if(size < sizeof(zlimdb_entity) || size > sizeof(zlimdb_entity) + getMaxDataSize())
+    return error = "Entity too large", (zlimdb_entity*)0;
+  if(!currentBatch)
+    currentBatch = popFreeBatch();
+  else if(currentBatch->data.size() + size > batchSize)
+  {
+    if(!submit(currentBatch))
+      return currentBatch = 0, (zlimdb_entity*)0;
+    currentBatch = popFreeBatch();
+  }
+  if(!currentBatch)
+    return error = "Aborted", (zlimdb_entity*)0;
+  size_t offset = currentBatch->data.size();
+  currentBatch->data.resize(offset + size);
+  ++currentBatch->count;
+  ++entityCount;
+  byteCount += size;
+  return (zlimdb_entity*)((byte_t*)currentBatch->data + offset);
+}
+
+bool_t BulkAdder::submit(Batch* batch)
+{
+  mutex.lock();
+  fullBatches.append(batch);
+  mutex.unlock();
+  fullBatchCount.signal();
+  for(Array<Sender*>::Iterator i = senders.begin(), end = senders.end(); i != end; ++i)
+    if((*i)->failed)
+      return error = (*i)->error, false;
+  return true;
+}
+
+bool_t BulkAdder::flush()
+{
+  // hand a partially filled batch to the senders, so that a slow stream of entities is not held back
+  if(!currentBatch || !currentBatch->count)
+    return true;
+  Batch* batch = currentBatch;
+  currentBatch = 0;
+  return submit(batch);
+}
+
+bool_t BulkAdder::finish()
+{
+  if(currentBatch)
+  {
+    if(currentBatch->count)
+      submit(currentBatch);
+    else
+      pushFreeBatch(currentBatch);
+    currentBatch = 0;
+  }
+  for(Array<Sender*>::Iterator i = senders.begin(), end = senders.end(); i != end; ++i)
+    submit(0);
+  uint64_t failedCount = 0;
+  for(Array<Sender*>::Iterator i = senders.begin(), end = senders.end(); i != end; ++i)
+  {
+    (*i)->thread.join();
+    failedCount += (*i)->failedCount;
+    if(!(*i)->error.isEmpty())
+      error = (*i)->error;
+  }
+  entityCount -= failedCount;
+  stop();
+  return failedCount == 0;
+}
+
+void_t BulkAdder::abort()
+{
+  // may be called from another thread to cancel a reader waiting for a free batch and senders waiting for a hanging server
+  aborted = true;
+  for(Array<Sender*>::Iterator i = senders.begin(), end = senders.end(); i != end; ++i)
+    if((*i)->connection.isOpen())
+      zlimdb_interrupt((*i)->connection);
+  freeBatchCount.signal();
+}
+
+void_t BulkAdder::stop()
+{
+  for(Array<Sender*>::Iterator i = senders.begin(), end = senders.end(); i != end; ++i)
+  {
+    Sender* sender = *i;
+    if(sender->connection.isOpen())
+      zlimdb_interrupt(sender->connection);
+    submit(0);
+  }
+  for(Array<Sender*>::Iterator i = senders.begin(), end = senders.end(); i != end; ++i)
+  {
+    (*i)->thread.join();
+    delete *i;
+  }
+  senders.clear();
+  for(Array<Batch*>::Iterator i = batches.begin(), end = batches.end(); i != end; ++i)
+    delete *i;
+  batches.clear();
+  freeBatches.clear();
+  fullBatches.clear();
+  while(freeBatchCount.tryWait());
+  while(fullBatchCount.tryWait());
+  currentBatch = 0;
+}
+
+BulkAdder::Batch* BulkAdder::popFreeBatch()
+{
+  freeBatchCount.wait();
+  if(aborted)
+    return freeBatchCount.signal(), (Batch*)0;
+  mutex.lock();
+  Batch* batch = freeBatches.front();
+  freeBatches.removeFront();
+  mutex.unlock();
+  batch->data.resize(0);
+  batch->count = 0;
+  return batch;
+}
+
+BulkAdder::Batch* BulkAdder::popFullBatch()
+{
+  fullBatchCount.wait();
+  mutex.lock();
+  Batch* batch = fullBatches.front();
+  fullBatches.removeFront();
+  mutex.unlock();
+  return batch;
+}
+
+void_t BulkAdder::pushFreeBatch(Batch* batch)
+{
+  mutex.lock();
+  freeBatches.append(batch);
+  mutex.unlock();
+  freeBatchCount.signal();
+}
+
+uint_t BulkAdder::Sender::threadProc(void_t* param)
+{
+  Sender* sender = (Sender*)param;
+  BulkAdder* adder = sender->adder;
+  for(;;)
+  {
+    Batch* batch = adder->popFullBatch();
+    if(!batch)
+      break;
+    const byte_t* pos = batch->data;
+    for(uint_t i = 0; i < batch->count; ++i)
+    {
+      const zlimdb_entity* entity = (const zlimdb_entity*)pos;
+      pos += entity->size;
+      if(sender->failed || adder->aborted)
+      {
+        ++sender->failedCount;
+        continue;
+      }
+      uint64_t id;
+      if(zlimdb_add(sender->connection, adder->tableId, entity, &id) != 0)
+      {
+        sender->error = Connection::getZlimdbError();
+        sender->failed = true;
+        ++sender->failedCount;
+      }
+    }
+    adder->pushFreeBatch(batch);
+  }
+  return 0;
+}
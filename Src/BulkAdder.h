@@ -0,0 +1,85 @@
+
+#pragma once
+
+#include <nstd/Thread.h>
+#include <nstd/Mutex.h>
+#include <nstd/Semaphore.h>
+#include <nstd/List.h>
+#include <nstd/Array.h>
+#include <nstd/Buffer.h>
+
+#include <zlimdbprotocol.h>
+
+#include "Connection.h"
+
+class BulkAdder
+{
+public:
+  BulkAdder();
+  ~BulkAdder();
+
+  String getLastError() const {return error;}
+
+  bool_t start(const String& userName, const String& password, const String& address, uint32_t tableId, uint_t connections);
+
+  bool_t add(const void_t* data, size_t size, uint64_t time);
+  bool_t add(const zlimdb_entity& entity);
+
+  bool_t flush();
+  bool_t finish();
+  void_t abort();
+
+  uint64_t getEntityCount() const {return entityCount;}
+  uint64_t getByteCount() const {return byteCount;}
+
+  static size_t getMaxDataSize();
+
+private:
+  enum
+  {
+    batchSize = 256 * 1024,
+  };
+
+  struct Batch
+  {
+    Buffer data;
+    uint_t count;
+  };
+
+  class Sender
+  {
+  public:
+    BulkAdder* adder;
+    Connection connection;
+    Thread thread;
+    uint64_t failedCount;
+    volatile bool_t failed;
+    String error;
+
+  public:
+    static uint_t threadProc(void_t* param);
+  };
+
+private:
+  String error;
+  uint32_t tableId;
+  Array<Sender*> senders;
+  Array<Batch*> batches;
+  Batch* currentBatch;
+  Mutex mutex;
+  List<Batch*> freeBatches;
+  List<Batch*> fullBatches;
+  Semaphore freeBatchCount;
+  Semaphore fullBatchCount;
+  uint64_t entityCount;
+  uint64_t byteCount;
+  volatile bool_t aborted;
+
+private:
+  zlimdb_entity* reserve(size_t size);
+  bool_t submit(Batch* batch);
+  Batch* popFreeBatch();
+  Batch* popFullBatch();
+  void_t pushFreeBatch(Batch* batch);
+  void_t stop();
+};
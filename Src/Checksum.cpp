@@ -0,0 +1,135 @@
+
+#include <nstd/Map.h>
+#include <nstd/Debug.h>
+
+#include "Tools/Fnv.h"
+
+#include "Checksum.h"
+
+Checksum::Checksum(uint64_t rangeSize, uint_t workers) :
+  rangeSize(rangeSize ? rangeSize : 1), workerCount(workers ? workers : 1), queued(queueSize), free(queueSize), freeCount(queueSize),
+  keepRunning(false), entityCount(0), hash(Fnv::offset)
+{
+  slots = new Buffer[queueSize];
+  for(uint32_t i = 0; i < queueSize; ++i)
+    VERIFY(free.push(&slots[i]));
+}
+
+Checksum::~Checksum()
+{
+  finish();
+  delete[] slots;
+}
+
+uint64_t Checksum::hashEntity(const zlimdb_entity& entity)
+{
+  uint64_t hash = Fnv::hash(Fnv::hash(Fnv::offset, entity.id), entity.time);
+  return Fnv::hash(hash, &entity + 1, entity.size - sizeof(zlimdb_entity));
+}
+
+bool_t Checksum::start()
+{
+  keepRunning = true;
+  for(uint_t i = 0; i < workerCount; ++i)
+  {
+    Worker* worker = new Worker;
+    worker->checksum = this;
+    workers.append(worker);
+    if(!worker->thread.start(Worker::threadProc, worker))
+      return finish(), false;
+  }
+  return true;
+}
+
+void_t Checksum::add(const void_t* data, size_t size)
+{
+  // the receiving thread only copies the block, hashing happens on the workers
+  freeCount.wait();
+  Buffer* slot;
+  VERIFY(free.pop(slot));
+  slot->assign((const byte_t*)data, size);
+  VERIFY(queued.push(slot));
+  queuedCount.signal();
+}
+
+void_t Checksum::finish()
+{
+  if(!keepRunning)
+    return;
+  keepRunning = false;
+  for(size_t i = 0; i < workers.size(); ++i)
+    queuedCount.signal();
+  Map<uint64_t, Range> sortedRanges;
+  for(Array<Worker*>::Iterator i = workers.begin(), end = workers.end(); i != end; ++i)
+  {
+    Worker* worker = *i;
+    worker->thread.join();
+    for(HashMap<uint64_t, Range>::Iterator j = worker->ranges.begin(), rangesEnd = worker->ranges.end(); j != rangesEnd; ++j)
+    {
+      Map<uint64_t, Range>::Iterator it = sortedRanges.find(j.key());
+      if(it == sortedRanges.end())
+        sortedRanges.append(j.key(), *j);
+      else
+      {
+        it->count += j->count;
+        it->hash += j->hash;
+      }
+    }
+    delete worker;
+  }
+  workers.clear();
+
+  ranges.clear();
+  ranges.reserve(sortedRanges.size());
+  for(Map<uint64_t, Range>::Iterator i = sortedRanges.begin(), end = sortedRanges.end(); i != end; ++i)
+  {
+    const Range& range = *i;
+    ranges.append(range);
+    entityCount += range.count;
+    hash = Fnv::hash(Fnv::hash(Fnv::hash(hash, range.firstId), range.count), range.hash);
+  }
+}
+
+uint_t Checksum::Worker::threadProc(void_t* param)
+{
+  Worker* worker = (Worker*)param;
+  worker->checksum->process(*worker);
+  return 0;
+}
+
+void_t Checksum::process(Worker& worker)
+{
+  for(Buffer* slot;;)
+  {
+    queuedCount.wait();
+    if(!queued.pop(slot))
+    {
+      if(!keepRunning)
+        break;
+      continue;
+    }
+    const byte_t* pos = *slot;
+    const byte_t* end = pos + slot->size();
+    while(pos + sizeof(zlimdb_entity) <= end)
+    {
+      const zlimdb_entity* entity = (const zlimdb_entity*)pos;
+      if(entity->size < sizeof(zlimdb_entity) || pos + entity->size > end)
+        break;
+      uint64_t index = entity->id / rangeSize;
+      HashMap<uint64_t, Range>::Iterator it = worker.ranges.find(index);
+      Range* range;
+      if(it == worker.ranges.end())
+      {
+        Range newRange = {index * rangeSize, 0, 0};
+        range = &worker.ranges.append(index, newRange);
+      }
+      else
+        range = &*it;
+      ++range->count;
+      range->hash += hashEntity(*entity);
+      pos += entity->size;
+    }
+    VERIFY(free.push(slot));
+    freeCount.signal();
+  }
+}
@@ -0,0 +1,82 @@
+
+#pragma once
+
+#include <nstd/Array.h>
+#include <nstd/Buffer.h>
+#include <nstd/HashMap.h>
+#include <nstd/Thread.h>
+#include <nstd/Semaphore.h>
+
+#include <zlimdbprotocol.h>
+
+#include "Tools/LockFreeQueue.h"
+
+class Checksum
+{
+public:
+  struct Range
+  {
+    uint64_t firstId;
+    uint64_t count;
+    uint64_t hash; // sum of the entity hashes, so blocks can be hashed in any order
+  };
+
+  enum
+  {
+    defaultRangeSize = 4096,
+    defaultWorkers = 4,
+  };
+
+public:
+  Checksum(uint64_t rangeSize = defaultRangeSize, uint_t workers = defaultWorkers);
+  ~Checksum();
+
+  bool_t start();
+  void_t add(const void_t* data, size_t size);
+  void_t finish();
+
+  uint64_t getRangeSize() const {return rangeSize;}
+  const Array<Range>& getRanges() const {return ranges;}
+  uint64_t getEntityCount() const {return entityCount;}
+  uint64_t getHash() const {return hash;}
+
+  static uint64_t hashEntity(const zlimdb_entity& entity);
+
+private:
+  enum
+  {
+    queueSize = 16,
+  };
+
+  class Worker
+  {
+  public:
+    Checksum* checksum;
+    Thread thread;
+    HashMap<uint64_t, Range> ranges;
+
+  public:
+    static uint_t threadProc(void_t* param);
+  };
+
+private:
+  uint64_t rangeSize;
+  uint_t workerCount;
+  Array<Worker*> workers;
+  Buffer* slots;
+  LockFreeQueue<Buffer*> queued;
+  LockFreeQueue<Buffer*> free;
+  Semaphore queuedCount;
+  Semaphore freeCount;
+  volatile bool_t keepRunning;
+  Array<Range> ranges;
+  uint64_t entityCount;
+  uint64_t hash;
+
+private:
+  void_t process(Worker& worker);
+
+private:
+  Checksum(const Checksum&);
+  Checksum& operator=(const Checksum&);
+};
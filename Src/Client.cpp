@@ -4,15 +4,37 @@
 #include <nstd/Time.h>
 #include <nstd/Debug.h>
 #include <nstd/File.h>
+#include <nstd/Memory.h>
+#include <nstd/Atomic.h>
 
 #include <zlimdbclient.h>
 
 #include "Tools/ClientProtocol.h"
+#include "Tools/BlockFile.h"
 
+#include "BulkAdder.h"
+#include "Benchmark.h"
+#include "Mirror.h"
+#include "Replicator.h"
+#include "ShardedWriter.h"
+#include "Top.h"
+#include "Ping.h"
+#include "Subscription.h"
+#include "Merge.h"
+#include "ParallelQuery.h"
 #include "Client.h"
 
-Client::Client() : zdb(0), selectedTable(0)
+const String Client::noString;
+
+Client::Client() : zdb(0), keepRunning(false), actions(actionQueueSize), freeActionStrings(actionQueueSize), freeRequestStrings(requestQueueSize),
+  interruptPending(0), selectedTable(0), requests(requestQueueSize), nextRequestId(0), activeTop(0), activePing(0), pingDrained(0), currentCounters(0), statsDumpInterval(0)
 {
+  workerStats = stats.createBlock();
+  actionStrings = new ActionStrings[actionQueueSize + requestQueueSize];
+  for(uint32_t i = 0; i < actionQueueSize; ++i)
+    VERIFY(freeActionStrings.push(&actionStrings[i]));
+  for(uint32_t i = actionQueueSize; i < actionQueueSize + requestQueueSize; ++i)
+    VERIFY(freeRequestStrings.push(&actionStrings[i]));
   VERIFY(zlimdb_init() == 0);
 }
 
@@ -20,43 +42,94 @@ Client::~Client()
 {
   disconnect();
   VERIFY(zlimdb_cleanup() == 0);
+  delete[] actionStrings;
 }
 
-bool_t Client::connect(const String& user, const String& password, const String& address)
+bool_t Client::connect(const String& user, const String& password, const String& address, uint_t laneCount)
 {
   disconnect();
 
   // create connection
-  zdb = zlimdb_create((void (*)(void*, const zlimdb_header*))(void (*)(void*, const void*))zlimdbCallback, this);
-  if(!zdb)
-    return error = getZlimdbError(), false;
-  uint16_t port = 0;
-  String host = address;
-  const char_t* colon = address.find(':');
-  if(colon)
-  {
-    port = String::toUInt(colon + 1);
-    host = address.substr(0, colon - (const char_t*)address);
-  }
-  if(zlimdb_connect(zdb, host, port, user, password) != 0)
-    return error = getZlimdbError(), false;
+  if(!connection.open(user, password, address, zlimdbCallback, this))
+    return error = connection.getLastError(), false;
+  zdb = connection;
+  userName = user;
+  this->password = password;
+  this->address = address;
+
+  // fill the table cache, find and list fall back to server requests if the tables table cannot be subscribed
+  loadTables();
 
   // start receive thread
   keepRunning = true;
   if(!thread.start(threadProc, this))
     return error = Error::getErrorString(), false;
+
+  // open the lanes, each with a connection of its own since a connection handles one request at a time, requests are spread over them by table
+  for(uint_t i = 0; i < laneCount; ++i)
+  {
+    Lane* lane = new Lane;
+    lane->client = this;
+    lane->stats = stats.createBlock();
+    lanes.append(lane);
+    if(!lane->connection.open(user, password, address))
+      return error = lane->connection.getLastError(), disconnect(), false;
+    if(!lane->thread.start(Lane::threadProc, lane))
+      return error = Error::getErrorString(), disconnect(), false;
+  }
   return true;
 }
 
 void_t Client::disconnect()
 {
+  keepRunning = false;
+  connectionMutex.lock();
   if(zdb)
-  {
-    keepRunning = false;
     zlimdb_interrupt(zdb);
+  connectionMutex.unlock();
+  reconnectSignal.set();
+  for(Array<Lane*>::Iterator i = lanes.begin(), end = lanes.end(); i != end; ++i)
+    (*i)->requestCount.signal();
+  for(Array<Lane*>::Iterator i = lanes.begin(), end = lanes.end(); i != end; ++i)
+  {
+    Lane* lane = *i;
+    lane->thread.join();
+    for(Action action; lane->requests.pop(action);)
+    {
+      cancelRequest(action);
+      releaseStrings(freeRequestStrings, action);
+    }
+    delete lane;
   }
+  lanes.clear();
   thread.join();
-  actions.clear();
+  connection.close();
+  zdb = 0;
+  reconnectSignal.reset();
+  stopMirrors();
+  deleteReplications(true);
+  stopTop(false);
+  stopPing();
+  stopSubscriptions();
+  timeIndex.clear();
+  tableCache.clear();
+  for(Action action; actions.pop(action);)
+  {
+    if(action.requestId)
+      cancelRequest(action);
+    releaseStrings(freeActionStrings, action);
+  }
+  for(Action action; requests.pop(action);)
+  {
+    cancelRequest(action);
+    releaseStrings(freeRequestStrings, action);
+  }
+  requestMutex.lock();
+  pendingRequests.clear();
+  pendingTables.clear();
+  requestMutex.unlock();
+  requestSignal.set();
+  interruptPending = 0;
   selectedTable = 0;
 }
 
@@ -66,235 +139,2132 @@ uint_t Client::threadProc(void_t* param)
   return client->process();;
 }
 
+uint_t Client::Lane::threadProc(void_t* param)
+{
+  Lane* lane = (Lane*)param;
+  Client* client = lane->client;
+  Buffer buffer;
+  buffer.resize(ZLIMDB_MAX_MESSAGE_SIZE);
+  for(Action action;;)
+  {
+    lane->requestCount.wait();
+    if(!client->keepRunning)
+      break;
+    // the own queue keeps the order of each table, shared requests are taken in between when there is nothing of its own to do
+    while(client->keepRunning && (lane->requests.pop(action) || client->requests.pop(action)))
+    {
+      // a lost connection is opened again for the next request, the requests in between fail
+      if((lane->connection.isOpen() && zlimdb_is_connected(lane->connection) == 0) ||
+         lane->connection.open(client->userName, client->password, client->address))
+        client->handleRequest(lane->connection, action, buffer, *lane->stats, lane->codec);
+      else
+        client->failRequest(action, lane->connection.getLastError());
+      releaseStrings(client->freeRequestStrings, action);
+    }
+  }
+  return 0;
+}
+
 uint8_t Client::process()
 {
-  while(keepRunning && zlimdb_is_connected(zdb) == 0)
-    if(zlimdb_exec(zdb, 5 * 60 * 1000) != 0)
+  while(keepRunning)
+  {
+    if(zlimdb_is_connected(zdb) != 0)
+    {
+      Console::errorf("error: Connection lost\n");
+      if(!reconnect())
+        break;
+    }
+    int64_t timeout = 5 * 60 * 1000;
+    if(statsDumpInterval)
+    {
+      int64_t now = Time::ticks();
+      if(now >= nextStatsDump)
+      {
+        dumpStats();
+        nextStatsDump = now + statsDumpInterval;
+      }
+      timeout = nextStatsDump - now;
+    }
+    if(!merges.isEmpty())
+    {
+      int64_t now = Time::time();
+      for(List<Merge*>::Iterator i = merges.begin(), end = merges.end(); i != end; ++i)
+        (*i)->advance(now);
+      if(timeout > mergeInterval)
+        timeout = mergeInterval;
+    }
+    if(activePing)
+    {
+      int64_t now = Time::ticks();
+      if(now >= activePing->getNextSample())
+      {
+        samplePing();
+        continue;
+      }
+      if(timeout > activePing->getNextSample() - now)
+        timeout = activePing->getNextSample() - now;
+    }
+    if(activeTop)
+    {
+      int64_t now = Time::ticks();
+      if(now >= activeTop->getNextRefresh())
+        activeTop->refresh(now);
+      if(timeout > activeTop->getNextRefresh() - now)
+        timeout = activeTop->getNextRefresh() - now;
+    }
+    if(!actions.isEmpty())
+    {
+      // actions enqueued while the connection was replaced did not interrupt the current handle
+      handleActions();
+      continue;
+    }
+    if(zlimdb_exec(zdb, (unsigned int)timeout) != 0)
       switch(zlimdb_errno())
       {
       case zlimdb_local_error_interrupted:
-        {
-          Action action = {quitAction};
-          bool actionEmpty = true;
-          do
-          {
-            actionMutex.lock();
-            if(!actions.isEmpty())
-            {
-              action = actions.front();
-              actions.removeFront();
-              actionEmpty = actions.isEmpty();
-            }
-            actionMutex.unlock();
-            handleAction(action);
-          } while(!actionEmpty);
-        }
+        handleActions();
         break;
       case zlimdb_local_error_timeout:
         break;
       default:
-        return Console::errorf("error: Could not receive data: %s\n", (const char_t*)getZlimdbError()), 1;
+        countError(), Console::errorf("error: Could not receive data: %s\n", (const char_t*)Connection::getZlimdbError());
+        if(!reconnect())
+          return 1;
+        break;
       }
+  }
   return 0;
 }
 
+bool_t Client::reconnect()
+{
+  // retry with exponential backoff, so a restarting server is not flooded with login attempts
+  int64_t delay = minReconnectDelay;
+  for(uint_t attempt = 1;; ++attempt)
+  {
+    connectionMutex.lock();
+    zdb = 0;
+    connectionMutex.unlock();
+    connection.close();
+    if(!keepRunning)
+      return false;
+    if(!connection.open(userName, password, address, zlimdbCallback, this))
+    {
+      Console::errorf("error: Could not reconnect (attempt %u): %s, retrying in %lld ms\n", attempt, (const char_t*)connection.getLastError(), delay);
+      reconnectSignal.wait(delay);
+      delay = delay * 2 > maxReconnectDelay ? (int64_t)maxReconnectDelay : delay * 2;
+      continue;
+    }
+    connectionMutex.lock();
+    zdb = connection;
+    connectionMutex.unlock();
+    Console::printf("reconnected to %s\n", (const char_t*)address);
+    if(restoreSubscriptions())
+      return true;
+    Console::errorf("error: Connection lost while restoring subscriptions\n");
+  }
+}
+
+bool_t Client::restoreSubscriptions()
+{
+  // restore the server side state, mirrors and subscriptions continue after the last id they received
+  tableCache.clear();
+  loadTables();
+
+  // entries that cannot be resubscribed while the connection is up (e.g. their table was removed) are dropped, since they would not receive anything anymore
+  for(HashMap<uint32_t, Mirror*>::Iterator i = mirrors.begin(), end = mirrors.end(); i != end;)
+  {
+    if(subscribeMirror(**i))
+    {
+      ++i;
+      continue;
+    }
+    if(zlimdb_is_connected(zdb) != 0)
+      return false;
+    Console::errorf("error: Stopped mirror of table %u\n", i.key());
+    (*i)->sync();
+    delete *i;
+    i = mirrors.remove(i);
+  }
+  for(HashMap<uint32_t, Subscription*>::Iterator i = subscriptions.begin(), end = subscriptions.end(); i != end;)
+  {
+    if(subscribeTable(**i))
+    {
+      ++i;
+      continue;
+    }
+    if(zlimdb_is_connected(zdb) != 0)
+      return false;
+    Console::errorf("error: Removed subscription of table %u\n", i.key());
+    deleteSubscription(*i);
+    i = subscriptions.remove(i);
+  }
+  if(activeTop && !subscribeTop())
+  {
+    if(zlimdb_is_connected(zdb) != 0)
+      return false;
+    Console::errorf("error: Stopped top\n");
+    stopTop(true);
+  }
+  return true;
+}
+
+bool_t Client::resumeQuery(uint64_t sinceId)
+{
+  if(zlimdb_is_connected(zdb) == 0)
+    return false; // the server rejected the request
+  countError(), Console::errorf("error: Connection lost: %s\n", (const char_t*)Connection::getZlimdbError());
+  if(!reconnect())
+    return false;
+  Console::printf("resuming query after id %llu\n", sinceId);
+  return true;
+}
+
+void_t Client::handleActions()
+{
+  // clear the pending flag before draining, so producers only interrupt again for actions that might be missed by this pass
+  Atomic::swap(interruptPending, 0);
+  for(Action action; actions.pop(action);)
+  {
+    handleAction(action);
+    releaseStrings(freeActionStrings, action);
+  }
+}
+
 void_t Client::handleAction(const Action& action)
+{
+  if(action.requestId)
+  {
+    if(requestBuffer.isEmpty())
+      requestBuffer.resize(ZLIMDB_MAX_MESSAGE_SIZE);
+    return handleRequest(zdb, action, requestBuffer, *workerStats, codec);
+  }
+
+  // actions on the data of a single table run on the lane of that table, so a long scan does not hold back anything on other tables,
+  // the remaining actions wait for the lane work on the tables they use to keep the order in which they were entered
+  if(!lanes.isEmpty())
+    switch(action.type)
+    {
+    case queryAction:
+    case syncAction:
+    case addAction:
+    case clearTableAction:
+      return dispatchAction(action);
+    case findTableAction:
+      if(!tableCache.isLoaded())
+        return dispatchAction(action); // taken by whichever lane is idle
+      break;
+    case listUsersAction:
+    case addUserAction:
+    case listTablesAction:
+    case createTableAction:
+    case selectTableAction:
+    case formatAction:
+    case statsDumpAction:
+    case unsubscribeAction:
+    case listSubscriptionsAction:
+    case pingAction:
+    case replicateAction:
+    case stopReplicationsAction:
+    case topAction:
+    case stopTopAction:
+      break;
+    case removeTableAction:
+    case copyTableAction:
+    case importAction:
+    case exportAction:
+    case restoreAction:
+    case benchAction:
+    case queryRangeAction:
+    case headAction:
+    case tailAction:
+    case parallelQueryAction:
+    case compressAction:
+    case aggregateAction:
+      waitForTable(selectedTable);
+      break;
+    case mirrorAction:
+      waitForTable((uint32_t)action.param1);
+      break;
+    default:
+      wait(); // actions on several tables and the end of a script
+      break;
+    }
+
+  actionStart = Time::microTicks();
+  responded = false;
+  currentCounters = &workerStats->counters[action.type];
+  ++currentCounters->count;
+  currentCounters->queueTime += actionStart - action.enqueueTime;
+  executeAction(action);
+  output.flush();
+  currentCounters->totalTime += Time::microTicks() - actionStart;
+  currentCounters = 0;
+}
+
+void_t Client::measureResponse(const void_t* data)
+{
+  if(!currentCounters)
+    return;
+  if(!responded)
+  {
+    responded = true;
+    ++currentCounters->responseCount;
+    currentCounters->firstResponseTime += Time::microTicks() - actionStart;
+  }
+  const zlimdb_header* header = (const zlimdb_header*)data;
+  currentCounters->bytes += header->size;
+  for(const zlimdb_entity* entity = zlimdb_get_first_entity((zlimdb_header*)header, sizeof(zlimdb_entity));
+      entity;
+      entity = zlimdb_get_next_entity((zlimdb_header*)header, sizeof(zlimdb_entity), entity))
+    ++currentCounters->entities;
+}
+
+const char_t* Client::getActionName(ActionType type)
+{
+  static const char_t* names[] = {"quit", "listUsers", "addUser", "list", "create", "remove", "clear", "copy", "find", "select", "query", "add",
+    "subscribe", "sync", "import", "export", "restore", "bench", "mirror", "queryRange", "head", "tail", "statsDump", "format", "unsubscribe",
+    "subscriptions", "merge", "pquery", "compress", "replicate", "stopReplications", "checksum", "diff", "ping", "shardImport", "shardQuery", "top", "stopTop", "aggregate"};
+  return (uint_t)type < sizeof(names) / sizeof(*names) ? names[type] : "";
+}
+
+String Client::formatStats()
+{
+  Stats::Counters counters[Stats::maxSlots];
+  stats.merge(counters);
+  String result;
+  result.printf("%-10s %8s %6s %10s %10s %10s %10s %12s %10s\n", "action", "count", "errors", "queue us", "send us", "first us", "total us", "bytes", "entities");
+  for(uint_t i = 0; i < Stats::maxSlots; ++i)
+  {
+    const Stats::Counters& c = counters[i];
+    if(!c.count)
+      continue;
+    String line;
+    line.printf("%-10s %8llu %6llu %10llu %10llu %10llu %10llu %12llu %10llu\n", getActionName((ActionType)i), c.count, c.errors,
+      c.queueTime / c.count, c.sendTime / c.count, c.responseCount ? c.firstResponseTime / c.responseCount : 0, c.totalTime / c.count, c.bytes, c.entities);
+    result += line;
+  }
+  return result;
+}
+
+void_t Client::printStats()
+{
+  Console::print(formatStats());
+}
+
+void_t Client::dumpStats()
+{
+  File file;
+  if(!file.open(statsDumpFile, File::writeFlag | File::appendFlag))
+  {
+    Console::errorf("error: Could not open file %s: %s\n", (const char_t*)statsDumpFile, (const char_t*)Error::getErrorString());
+    statsDumpInterval = 0;
+    return;
+  }
+  String header;
+  header.printf("time=%lld\n", Time::time());
+  file.write(header + formatStats());
+}
+
+void_t Client::executeAction(const Action& action)
 {
   switch(action.type)
   {
   case listUsersAction:
+  case listTablesAction:
     {
+      bool_t userNames = action.type == listUsersAction;
+      if(tableCache.isLoaded())
+      {
+        for(TableCache::Iterator i = tableCache.begin(), end = tableCache.end(); i != end; ++i)
+          writeTable(**i, userNames);
+        break;
+      }
       if(zlimdb_query(zdb, zlimdb_table_tables, zlimdb_query_type_all, 0) != 0)
-        return Console::errorf("error: Could not send query: %s\n", (const char_t*)getZlimdbError()), (void)0;
+        return countError(), Console::errorf("error: Could not send query: %s\n", (const char_t*)Connection::getZlimdbError()), (void)0;
+      measureSent();
       char_t buffer[ZLIMDB_MAX_MESSAGE_SIZE];
       while(zlimdb_get_response(zdb, (zlimdb_header*)buffer, ZLIMDB_MAX_MESSAGE_SIZE) == 0)
+      {
+        measureResponse(buffer);
         for(const zlimdb_table_entity* table = (const zlimdb_table_entity*)zlimdb_get_first_entity((zlimdb_header*)buffer, sizeof(zlimdb_table_entity));
             table;
             table = (const zlimdb_table_entity*)zlimdb_get_next_entity((zlimdb_header*)buffer, sizeof(zlimdb_table_entity), &table->entity))
-        {
-          String tableName;
-          if(!ClientProtocol::getString(table->entity, sizeof(zlimdb_table_entity), table->name_size, tableName))
-            continue;
-          if(!tableName.startsWith("users/"))
-            continue;
-          tableName.resize(tableName.length()); // enfore NULL termination
-          Console::printf("%6llu: %s\n", table->entity.id, (const char_t*)File::basename(File::dirname(tableName)));
-        }
+          writeTable(*table, userNames);
+      }
       if(zlimdb_errno() != zlimdb_local_error_none)
-        return Console::errorf("error: Could not receive query response: %s\n", (const char_t*)getZlimdbError()), (void)0;
+        return countError(), Console::errorf("error: Could not receive query response: %s\n", (const char_t*)Connection::getZlimdbError()), (void)0;
     }
     break;
   case addUserAction:
     {
-      const String userName = action.param1.toString();
-      const String password = action.param2.toString();
+      const String& userName = action.getString1();
+      const String& password = action.getString2();
       if(zlimdb_add_user(zdb, userName, password) != 0)
-        return Console::errorf("error: Could not send add user request: %s\n", (const char_t*)getZlimdbError()), (void)0;
+        return countError(), Console::errorf("error: Could not send add user request: %s\n", (const char_t*)Connection::getZlimdbError()), (void)0;
     }
     break;
-  case listTablesAction:
-    {
-      if(zlimdb_query(zdb, zlimdb_table_tables, zlimdb_query_type_all, 0) != 0)
-        return Console::errorf("error: Could not send query: %s\n", (const char_t*)getZlimdbError()), (void)0;
-      char_t buffer[ZLIMDB_MAX_MESSAGE_SIZE];
-      while(zlimdb_get_response(zdb, (zlimdb_header*)buffer, ZLIMDB_MAX_MESSAGE_SIZE) == 0)
-        for(const zlimdb_table_entity* table = (const zlimdb_table_entity*)zlimdb_get_first_entity((zlimdb_header*)buffer, sizeof(zlimdb_table_entity));
-            table;
-            table = (const zlimdb_table_entity*)zlimdb_get_next_entity((zlimdb_header*)buffer, sizeof(zlimdb_table_entity), &table->entity))
-        {
-          String tableName;
-          if(!ClientProtocol::getString(table->entity, sizeof(zlimdb_table_entity), table->name_size, tableName))
-            continue;
-          tableName.resize(tableName.length()); // enfore NULL termination
-          Console::printf("%6llu: %s\n", table->entity.id, (const char_t*)tableName);
-        }
-      if(zlimdb_errno() != zlimdb_local_error_none)
-        return Console::errorf("error: Could not receive query response: %s\n", (const char_t*)getZlimdbError()), (void)0;
-    }
+  case formatAction:
+    output.setFormat((OutputWriter::Format)action.param1);
     break;
   case selectTableAction:
-    selectedTable = action.param1.toUInt();
+    if(!action.getString1().isEmpty())
+    {
+      uint32_t tableId;
+      if(!findTableId(action.getString1(), tableId))
+        return;
+      selectedTable = tableId;
+    }
+    else
+      selectedTable = (uint32_t)action.param1;
     //Console::printf("selected table %u\n", action.param);
     break;
   case createTableAction:
     {
-      const String tableName = action.param1.toString();
+      const String& tableName = action.getString1();
       uint32_t tableId;
       if(zlimdb_add_table(zdb, tableName, &tableId) != 0)
-        return Console::errorf("error: Could not send add request: %s\n", (const char_t*)getZlimdbError()), (void)0;
+        return countError(), Console::errorf("error: Could not send add request: %s\n", (const char_t*)Connection::getZlimdbError()), (void)0;
+      if(tableCache.isLoaded())
+        tableCache.add(tableId, tableName);
       Console::printf("%6u: %s\n", tableId, (const char_t*)tableName);
     }
     break;
   case removeTableAction:
     {
       if(zlimdb_remove(zdb, zlimdb_table_tables, selectedTable) != 0)
-        return Console::errorf("error: Could not send remove request: %s\n", (const char_t*)getZlimdbError()), (void)0;
+        return countError(), Console::errorf("error: Could not send remove request: %s\n", (const char_t*)Connection::getZlimdbError()), (void)0;
+      tableCache.remove(selectedTable);
     }
     break;
   case clearTableAction:
     {
       if(zlimdb_clear(zdb, selectedTable) != 0)
-        return Console::errorf("error: Could not send clear request: %s\n", (const char_t*)getZlimdbError()), (void)0;
+        return countError(), Console::errorf("error: Could not send clear request: %s\n", (const char_t*)Connection::getZlimdbError()), (void)0;
     }
     break;
   case copyTableAction:
     {
-      const String tableName = action.param1.toString();
+      const String& tableName = action.getString1();
       uint32_t tableId;
       if(zlimdb_copy_table(zdb, selectedTable, tableName, &tableId) != 0)
-        return Console::errorf("error: Could not send copy request: %s\n", (const char_t*)getZlimdbError()), (void)0;
+        return countError(), Console::errorf("error: Could not send copy request: %s\n", (const char_t*)Connection::getZlimdbError()), (void)0;
+      if(tableCache.isLoaded())
+        tableCache.add(tableId, tableName);
       Console::printf("%6u: %s\n", tableId, (const char_t*)tableName);
     }
     break;
   case findTableAction:
     {
-      const String tableName = action.param1.toString();
+      const String& tableName = action.getString1();
       uint32_t tableId;
-      if(zlimdb_find_table(zdb, tableName, &tableId) != 0)
-        return Console::errorf("error: Could not send find request: %s\n", (const char_t*)getZlimdbError()), (void)0;
+      if(!findTableId(tableName, tableId))
+        return;
       Console::printf("%6u: %s\n", tableId, (const char_t*)tableName);
     }
     break;
   case queryAction:
     {
-      zlimdb_query_type queryType = zlimdb_query_type_all;
-      uint64_t param = 0;
-      if(!action.param1.isNull())
+      char_t buffer[ZLIMDB_MAX_MESSAGE_SIZE];
+      TimeIndex::Table& index = timeIndex.getTable(selectedTable);
+      for(uint64_t sinceId = action.param1;;)
       {
-        queryType = zlimdb_query_type_since_id;
-        param = action.param1.toUInt64();
+        zlimdb_query_type queryType = sinceId ? zlimdb_query_type_since_id : zlimdb_query_type_all;
+        if(zlimdb_query(zdb, selectedTable, queryType, sinceId) != 0)
+        {
+          if(resumeQuery(sinceId))
+            continue;
+          return countError(), Console::errorf("error: Could not send query: %s\n", (const char_t*)Connection::getZlimdbError()), (void)0;
+        }
+        measureSent();
+        while(zlimdb_get_response(zdb, (zlimdb_header*)buffer, ZLIMDB_MAX_MESSAGE_SIZE) == 0)
+        {
+          measureResponse(buffer);
+          for(const zlimdb_entity* entity = zlimdb_get_first_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity));
+              entity;
+              entity = zlimdb_get_next_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity), entity))
+          {
+            index.add(*entity);
+            writeEntity(*entity);
+            sinceId = entity->id;
+          }
+        }
+        if(zlimdb_errno() == zlimdb_local_error_none)
+          break;
+        if(!resumeQuery(sinceId))
+          return countError(), Console::errorf("error: Could not receive query response: %s\n", (const char_t*)Connection::getZlimdbError()), (void)0;
       }
-      if(zlimdb_query(zdb, selectedTable, queryType, param) != 0)
-        return Console::errorf("error: Could not send query: %s\n", (const char_t*)getZlimdbError()), (void)0;
-      char_t buffer[ZLIMDB_MAX_MESSAGE_SIZE];
-      while(zlimdb_get_response(zdb, (zlimdb_header*)buffer, ZLIMDB_MAX_MESSAGE_SIZE) == 0)
-        for(const zlimdb_entity* entity = zlimdb_get_first_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity));
-            entity;
-            entity = zlimdb_get_next_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity), entity))
-          Console::printf("id=%llu, size=%u, time=%llu\n", entity->id, (uint_t)entity->size, entity->time);
-      if(zlimdb_errno() != zlimdb_local_error_none)
-        return Console::errorf("error: Could not receive query response: %s\n", (const char_t*)getZlimdbError()), (void)0;
     }
     break;
   case subscribeAction:
     {
-      if(zlimdb_subscribe(zdb, selectedTable, zlimdb_query_type_all, 0, zlimdb_subscribe_flag_none) != 0)
-        return Console::errorf("error: Could not send subscribe request: %s\n", (const char_t*)getZlimdbError()), (void)0;
-      char_t buffer[ZLIMDB_MAX_MESSAGE_SIZE];
-      uint32_t size = sizeof(buffer);
-      while(zlimdb_get_response(zdb, (zlimdb_header*)buffer, ZLIMDB_MAX_MESSAGE_SIZE) == 0)
-        for(const zlimdb_entity* entity = zlimdb_get_first_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity));
-            entity;
-            entity = zlimdb_get_next_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity), entity))
-          Console::printf("id=%llu, size=%u, time=%llu\n", entity->id, (uint_t)entity->size, entity->time);
-      if(zlimdb_errno() != zlimdb_local_error_none)
-        return Console::errorf("error: Could not receive subscribe response: %s\n", (const char_t*)getZlimdbError()), (void)0;
+      Subscription* subscription = (Subscription*)action.userData;
+      if(!subscription)
+      {
+        // a console subscription prints the updates with its own writer and codec, since they are handled in the thread of the subscription
+        uint32_t tableId = action.param2 & subscribeTableFlag ? (uint32_t)action.param1 : selectedTable;
+        Printer* printer = new Printer;
+        printer->writer.setFormat(output.getFormat());
+        printer->decompress = compressedTables.contains(tableId);
+        Subscription::Policy policy = action.param2 & subscribeDropFlag ? Subscription::dropPolicy : Subscription::blockPolicy;
+        subscription = new Subscription(tableId, printUpdate, printer, policy, 256);
+      }
+      startSubscription(subscription);
+    }
+    break;
+  case compressAction:
+    if(action.param1 != compressShow)
+    {
+      compressionMutex.lock();
+      if(action.param1 == compressOn)
+        compressedTables.append(selectedTable);
+      else
+        compressedTables.remove(selectedTable);
+      compressionMutex.unlock();
+    }
+    else
+      showCompression();
+    break;
+  case mergeAction:
+    {
+      Merge* merge = (Merge*)action.userData;
+      merge->setFormat(output.getFormat());
+      merges.append(merge);
+      Subscription::Policy policy = action.param2 & subscribeDropFlag ? Subscription::dropPolicy : Subscription::blockPolicy;
+      for(uint_t i = 0; i < merge->getInputCount(); ++i)
+        startSubscription(new Subscription(merge->getTableId(i), Merge::handleUpdate, merge->getInput(i), policy, 256));
+    }
+    break;
+  case unsubscribeAction:
+    {
+      uint32_t tableId = action.param2 & subscribeTableFlag ? (uint32_t)action.param1 : selectedTable;
+      HashMap<uint32_t, Subscription*>::Iterator it = subscriptions.find(tableId);
+      if(it == subscriptions.end())
+        return Console::errorf("error: Table %u is not subscribed\n", tableId), (void)0;
+      Subscription* subscription = *it;
+      subscriptions.remove(it);
+      if(!mirrors.contains(tableId) && zlimdb_unsubscribe(zdb, tableId) != 0)
+        countError(), Console::errorf("error: Could not send unsubscribe request: %s\n", (const char_t*)Connection::getZlimdbError());
+      deleteSubscription(subscription);
+    }
+    break;
+  case topAction:
+    startTop((Top*)action.userData);
+    break;
+  case stopTopAction:
+    stopTop(true);
+    break;
+  case listSubscriptionsAction:
+    for(HashMap<uint32_t, Subscription*>::Iterator i = subscriptions.begin(), end = subscriptions.end(); i != end; ++i)
+    {
+      const Subscription* subscription = *i;
+      const Subscription::Counters& counters = subscription->getCounters();
+      Console::printf("%6u: %s updates=%llu, entities=%llu, dropped=%llu, maxQueued=%llu, maxLag=%lld us, lastId=%llu\n",
+        subscription->getTableId(), subscription->getPolicy() == Subscription::dropPolicy ? "drop" : "block",
+        counters.updates, counters.entities, counters.dropped, counters.maxQueued, counters.maxLag, subscription->getLastId());
+    }
+    for(List<Merge*>::Iterator i = merges.begin(), end = merges.end(); i != end; ++i)
+    {
+      const Merge* merge = *i;
+      String tables;
+      for(uint_t j = 0; j < merge->getInputCount(); ++j)
+      {
+        String tableId;
+        tableId.printf(j ? ",%u" : "%u", merge->getTableId(j));
+        tables += tableId;
+      }
+      Console::printf("merge %s: window=%lld ms, emitted=%llu, late=%llu, bufferedBlocks=%llu\n", (const char_t*)tables, merge->getWindow(),
+        merge->getEmittedCount(), merge->getLateCount(), (uint64_t)merge->getBufferedBlockCount());
     }
     break;
   case addAction:
     {
-      const String value = action.param1.toString();
+      const String& value = action.getString1();
       Buffer buffer;
       buffer.resize(sizeof(zlimdb_table_entity) + value.length());
       zlimdb_table_entity* entity = (zlimdb_table_entity*)(const byte_t*)buffer;
       ClientProtocol::setEntityHeader(entity->entity, 0, Time::time(), sizeof(zlimdb_table_entity) + value.length());
       ClientProtocol::setString(entity->entity, entity->name_size, sizeof(*entity), value);
+      if(compressedTables.contains(selectedTable))
+      {
+        // compress everything behind the entity header, so the decompressed entity is the same as an uncompressed one
+        size_t size;
+        const void_t* data = codec.compress(&entity->entity + 1, buffer.size() - sizeof(zlimdb_entity), BulkAdder::getMaxDataSize(), size);
+        if(!data || sizeof(zlimdb_entity) + size > ZLIMDB_MAX_MESSAGE_SIZE - sizeof(zlimdb_add_request))
+          return Console::errorf("error: Value exceeds maximum entity size\n"), (void)0;
+        Buffer compressed;
+        compressed.resize(sizeof(zlimdb_entity) + size);
+        zlimdb_entity* compressedEntity = (zlimdb_entity*)(byte_t*)compressed;
+        ClientProtocol::setEntityHeader(*compressedEntity, 0, entity->entity.time, (uint16_t)compressed.size());
+        Memory::copy(compressedEntity + 1, data, size);
+        buffer.swap(compressed);
+        entity = (zlimdb_table_entity*)(const byte_t*)buffer;
+      }
       if(zlimdb_add(zdb, selectedTable, &entity->entity, &entity->entity.id))
-        return Console::errorf("error: Could not send add request: %s\n", (const char_t*)getZlimdbError()), (void)0;
+        return countError(), Console::errorf("error: Could not send add request: %s\n", (const char_t*)Connection::getZlimdbError()), (void)0;
     }
     break;
   case syncAction:
     {
       int64_t serverTime, tableTime;
       if(zlimdb_sync(zdb, selectedTable, &serverTime, &tableTime))
-        return Console::errorf("error: Could not send sync request: %s\n", (const char_t*)getZlimdbError()), (void)0;
+        return countError(), Console::errorf("error: Could not send sync request: %s\n", (const char_t*)Connection::getZlimdbError()), (void)0;
       Console::printf("serverTime=%llu, tableTime=%llu, offset=%lld\n", serverTime, tableTime, serverTime - tableTime);
     }
     break;
+  case shardImportAction:
+    importShardFile(action.getString1(), (action.param2 & shardSizedFlag) != 0, action.getString2(), (uint_t)action.param1, (action.param2 & shardKeyFlag) != 0);
+    break;
+  case shardQueryAction:
+    readShards(action.getString1(), (uint_t)action.param1);
+    break;
+  case pingAction:
+    startPing((uint_t)action.param1, (uint_t)action.param2);
+    break;
+  case importAction:
+    importFile(action.getString1(), action.param1 != 0, (uint_t)action.param2);
+    break;
+  case exportAction:
+    exportFile(action.getString1(), action.param1);
+    break;
+  case restoreAction:
+    restoreFile(action.getString1(), (uint_t)action.param1);
+    break;
+  case queryRangeAction:
+    queryRange((int64_t)action.param1, (int64_t)action.param2);
+    break;
+  case aggregateAction:
+    {
+      Aggregator* aggregator = (Aggregator*)action.userData;
+      queryAggregate(*aggregator);
+      delete aggregator;
+    }
+    break;
+  case headAction:
+    queryHead(action.param1);
+    break;
+  case tailAction:
+    queryTail(action.param1);
+    break;
+  case checksumAction:
+    printChecksum(action.getString1());
+    break;
+  case diffAction:
+    diffTables(action.getString1(), action.getString2());
+    break;
+  case parallelQueryAction:
+    queryParallel((uint_t)action.param1, action.getString1());
+    break;
+  case statsDumpAction:
+    statsDumpFile = action.getString1();
+    statsDumpInterval = (int64_t)action.param1 * 1000;
+    nextStatsDump = Time::ticks() + statsDumpInterval;
+    break;
+  case mirrorAction:
+    startMirror((uint32_t)action.param1, action.getString1());
+    break;
+  case replicateAction:
+    startReplication((Replicator*)action.userData);
+    break;
+  case stopReplicationsAction:
+    deleteReplications(true);
+    break;
+  case benchAction:
+    {
+      Benchmark benchmark(userName, password, address);
+      if(!benchmark.parse(action.getString1(), selectedTable))
+        return Console::errorf("error: Invalid arguments: %s: bench %s\n", (const char_t*)benchmark.getLastError(), Benchmark::getUsage()), (void)0;
+      if(!benchmark.run())
+        return Console::errorf("error: Benchmark failed: %s\n", (const char_t*)benchmark.getLastError()), (void)0;
+    }
+    break;
   case quitAction:
+    if(activePing)
+      pingDrained = (Signal*)action.userData; // set when the samples are complete
+    else if(action.userData)
+      ((Signal*)action.userData)->set();
+    break;
+  }
+}
+
+void_t Client::dispatchAction(const Action& action)
+{
+  // the lane reports back through a printer of its own, since it writes concurrently with the worker and the other lanes
+  RequestPrinter* printer = new RequestPrinter;
+  printer->type = action.type;
+  printer->writer.setFormat(output.getFormat());
+  printer->decompress = isCompressed(selectedTable);
+  switch(action.type)
+  {
+  case findTableAction:
+    printer->name = action.getString1();
+    findTable(action.getString1(), printResult, printer);
+    break;
+  case queryAction:
+    query(selectedTable, action.param1, printResult, printer);
+    break;
+  case addAction:
+    {
+      // the value is the name of a table entity, as when it is added on the worker
+      uint16_t length = (uint16_t)action.getString1().length();
+      String data = String((const char_t*)&length, sizeof(length)) + action.getString1();
+      add(selectedTable, (const char_t*)data, data.length(), Time::time(), printResult, printer);
+    }
+    break;
+  case syncAction:
+    sync(selectedTable, printResult, printer);
+    break;
+  default:
+    clearTable(selectedTable, printResult, printer);
     break;
   }
 }
 
-void_t Client::enqueueAction(ActionType type, const Variant& param1, const Variant& param2)
+void_t Client::waitForTable(uint32_t tableId)
+{
+  for(;;)
+  {
+    requestSignal.reset();
+    requestMutex.lock();
+    bool_t pending = pendingTables.contains(tableId);
+    requestMutex.unlock();
+    if(!pending)
+      return;
+    requestSignal.wait(10);
+  }
+}
+
+void_t Client::printResult(void_t* userData, const Result& result)
 {
-  if(!zdb)
+  RequestPrinter* printer = (RequestPrinter*)userData;
+  for(Array<const zlimdb_entity*>::Iterator i = result.entities.begin(), end = result.entities.end(); i != end; ++i)
+    printer->writer.writeEntity(printer->decompress ? *printer->codec.decompress(**i) : **i);
+  if(!result.complete)
     return;
-  actionMutex.lock();
-  Action& action = actions.append(Action());
-  action.type = type;
-  action.param1 = param1;
-  action.param2 = param2;
-  actionMutex.unlock();
-  zlimdb_interrupt(zdb);
+  printer->writer.flush();
+  if(result.error)
+    Console::errorf("error: Could not complete %s request: %s\n", getActionName(printer->type), (const char_t*)result.errorString);
+  else if(printer->type == syncAction)
+    Console::printf("serverTime=%llu, tableTime=%llu, offset=%lld\n", result.serverTime, result.tableTime, result.serverTime - result.tableTime);
+  else if(printer->type == findTableAction)
+    Console::printf("%6u: %s\n", result.tableId, (const char_t*)printer->name);
+  delete printer;
 }
 
-void_t Client::zlimdbCallback(const void_t* data)
+void_t Client::abortImport(BulkAdder& adder, ShardedWriter* shards)
 {
-  const zlimdb_header* header = (const zlimdb_header*)data;
-  // todo: check sizes
-  switch(header->message_type)
+  // send what has been batched so far, like an import that ends normally
+  if(shards ? !shards->finish() : !adder.finish())
+    Console::errorf("error: Could not send add request: %s\n", (const char_t*)(shards ? shards->getLastError() : adder.getLastError()));
+}
+
+void_t Client::importFile(const String& fileName, bool_t sized, uint_t connections, ShardedWriter* shards)
+{
+  File file;
+  if(!file.open(fileName))
+    return Console::errorf("error: Could not open file %s: %s\n", (const char_t*)fileName, (const char_t*)Error::getErrorString()), (void)0;
+
+  // a sharded import routes each record to the adder of one of the shards instead
+  BulkAdder adder;
+  if(!shards && !adder.start(userName, password, address, selectedTable, connections))
+    return Console::errorf("error: Could not establish connection: %s\n", (const char_t*)adder.getLastError()), (void)0;
+  bool_t compress = !shards && compressedTables.contains(selectedTable);
+  uint64_t rawBytes = codec.getRawBytes(), encodedBytes = codec.getEncodedBytes();
+  int64_t compressTime = codec.getCompressTime();
+
+  // records are parsed straight out of a reused read buffer and copied once into the send batches of the adder
+  const size_t maxRecordSize = BulkAdder::getMaxDataSize() - (compress ? PayloadCodec::getOverhead() : 0);
+  Buffer buffer;
+  buffer.resize(1024 * 1024);
+  size_t bufferSize = 0;
+  bool_t eof = false;
+  int64_t startTime = Time::microTicks();
+  while(!eof)
   {
-  case zlimdb_message_error_response:
+    ssize_t read = file.read((byte_t*)buffer + bufferSize, buffer.size() - bufferSize);
+    if(read < 0)
     {
-      const zlimdb_error_response* errorResponse = (const zlimdb_error_response*)header;
-      Console::printf("subscribe: errorResponse=%s (%d)\n", (const char_t*)getZlimdbError(), (int)errorResponse->error);
+      Console::errorf("error: Could not read from file %s: %s\n", (const char_t*)fileName, (const char_t*)Error::getErrorString());
+      break;
     }
-    break;
-  default:
-    Console::printf("subscribe: messageType=%u\n", (uint_t)header->message_type);
-    break;
+    eof = read == 0;
+    bufferSize += read;
+
+    const byte_t* pos = buffer;
+    const byte_t* end = pos + bufferSize;
+    int64_t now = Time::time();
+    if(sized)
+      for(;;)
+      {
+        if(end - pos < (ssize_t)sizeof(uint32_t))
+          break;
+        uint32_t size;
+        Memory::copy(&size, pos, sizeof(size));
+        if(size > maxRecordSize)
+          return abortImport(adder, shards), Console::errorf("error: Record size %u exceeds maximum entity size\n", (uint_t)size), (void)0;
+        if((size_t)(end - pos) < sizeof(uint32_t) + size)
+          break;
+        BulkAdder& target = shards ? shards->route(pos + sizeof(uint32_t), size) : adder;
+        if(!addRecord(target, compress, pos + sizeof(uint32_t), size, now))
+          return abortImport(adder, shards), Console::errorf("error: Could not send add request: %s\n", (const char_t*)target.getLastError()), (void)0;
+        pos += sizeof(uint32_t) + size;
+      }
+    else
+      for(;;)
+      {
+        const byte_t* lineEnd = pos;
+        while(lineEnd < end && *lineEnd != '\n')
+          ++lineEnd;
+        if(lineEnd == end && (!eof || pos == end))
+          break;
+        size_t size = lineEnd - pos;
+        if(size > 0 && pos[size - 1] == '\r')
+          --size;
+        if(size > maxRecordSize)
+          return abortImport(adder, shards), Console::errorf("error: Line exceeds maximum entity size\n"), (void)0;
+        BulkAdder& target = shards ? shards->route(pos, size) : adder;
+        if(!addRecord(target, compress, pos, size, now))
+          return abortImport(adder, shards), Console::errorf("error: Could not send add request: %s\n", (const char_t*)target.getLastError()), (void)0;
+        pos = lineEnd < end ? lineEnd + 1 : lineEnd;
+      }
+
+    bufferSize = end - pos;
+    if(eof && bufferSize != 0)
+      return abortImport(adder, shards), Console::errorf("error: Truncated record at end of file\n"), (void)0;
+    Memory::move((byte_t*)buffer, pos, bufferSize);
+  }
+
+  if(shards ? !shards->finish() : !adder.finish())
+    Console::errorf("error: Could not send add request: %s\n", (const char_t*)(shards ? shards->getLastError() : adder.getLastError()));
+  printTransfer("imported", shards ? shards->getEntityCount() : adder.getEntityCount(), shards ? shards->getByteCount() : adder.getByteCount(), String(), startTime);
+  if(compress)
+  {
+    rawBytes = codec.getRawBytes() - rawBytes;
+    encodedBytes = codec.getEncodedBytes() - encodedBytes;
+    Console::printf("compressed %llu bytes to %llu bytes, ratio %.2f, %.3f s cpu\n", rawBytes, encodedBytes,
+      encodedBytes ? (double)rawBytes / (double)encodedBytes : 0., (double)(codec.getCompressTime() - compressTime) / 1000000.);
   }
 }
 
-String Client::getZlimdbError()
+bool_t Client::addRecord(BulkAdder& adder, bool_t compress, const void_t* data, size_t size, int64_t time)
 {
-  int err = zlimdb_errno();
-  if(err == zlimdb_local_error_system)
-    return Error::getErrorString();
-  else
+  if(!compress)
+    return adder.add(data, size, time);
+  data = codec.compress(data, size, BulkAdder::getMaxDataSize(), size);
+  if(!data)
+    return false;
+  return adder.add(data, size, time);
+}
+
+void_t Client::exportFile(const String& fileName, uint64_t sinceId)
+{
+  BlockFile file;
+  if(!file.create(fileName))
+    return Console::errorf("error: Could not create file %s: %s\n", (const char_t*)fileName, (const char_t*)file.getLastError()), (void)0;
+
+  int64_t startTime = Time::microTicks();
+  char_t buffer[ZLIMDB_MAX_MESSAGE_SIZE];
+  bool_t failed = false;
+  uint64_t count = 0;
+  TimeIndex::Table& index = timeIndex.getTable(selectedTable);
+  for(;;)
   {
-    const char* errstr = zlimdb_strerror(err);
-    return String(errstr, String::length(errstr));
+    zlimdb_query_type queryType = sinceId ? zlimdb_query_type_since_id : zlimdb_query_type_all;
+    if(zlimdb_query(zdb, selectedTable, queryType, sinceId) != 0)
+    {
+      if(resumeQuery(sinceId))
+        continue;
+      return countError(), Console::errorf("error: Could not send query: %s\n", (const char_t*)Connection::getZlimdbError()), (void)0;
+    }
+    measureSent();
+    while(zlimdb_get_response(zdb, (zlimdb_header*)buffer, ZLIMDB_MAX_MESSAGE_SIZE) == 0)
+    {
+      measureResponse(buffer);
+      if(failed)
+        continue; // drain the remaining responses
+      const zlimdb_header* header = (const zlimdb_header*)buffer;
+      if(header->size <= sizeof(zlimdb_header))
+        continue;
+      if(!file.write(*header))
+      {
+        Console::errorf("error: Could not write to file %s: %s\n", (const char_t*)fileName, (const char_t*)file.getLastError());
+        failed = true;
+        continue;
+      }
+      for(const zlimdb_entity* entity = zlimdb_get_first_entity((zlimdb_header*)header, sizeof(zlimdb_entity));
+          entity;
+          entity = zlimdb_get_next_entity((zlimdb_header*)header, sizeof(zlimdb_entity), entity))
+      {
+        index.add(*entity);
+        sinceId = entity->id;
+        ++count;
+      }
+    }
+    if(zlimdb_errno() == zlimdb_local_error_none)
+      break;
+    if(failed || !resumeQuery(sinceId))
+      return countError(), Console::errorf("error: Could not receive query response: %s\n", (const char_t*)Connection::getZlimdbError()), (void)0;
+  }
+  if(failed)
+    return;
+  String details;
+  details.printf(", %llu compressed", file.getCompressedSize());
+  printTransfer("exported", count, file.getRawSize(), details, startTime);
+}
+
+void_t Client::restoreFile(const String& fileName, uint_t connections)
+{
+  BlockFile file;
+  if(!file.open(fileName))
+    return Console::errorf("error: Could not open file %s: %s\n", (const char_t*)fileName, (const char_t*)file.getLastError()), (void)0;
+
+  BulkAdder adder;
+  if(!adder.start(userName, password, address, selectedTable, connections))
+    return Console::errorf("error: Could not establish connection: %s\n", (const char_t*)adder.getLastError()), (void)0;
+
+  int64_t startTime = Time::microTicks();
+  const zlimdb_header* header;
+  while((header = file.read()))
+    for(const zlimdb_entity* entity = zlimdb_get_first_entity((zlimdb_header*)header, sizeof(zlimdb_entity));
+        entity;
+        entity = zlimdb_get_next_entity((zlimdb_header*)header, sizeof(zlimdb_entity), entity))
+      if(!adder.add(*entity))
+        return adder.finish(), Console::errorf("error: Could not send add request: %s\n", (const char_t*)adder.getLastError()), (void)0;
+  if(!file.getLastError().isEmpty())
+    Console::errorf("error: Could not read from file %s: %s\n", (const char_t*)fileName, (const char_t*)file.getLastError());
+
+  if(!adder.finish())
+    Console::errorf("error: Could not send add request: %s\n", (const char_t*)adder.getLastError());
+  printTransfer("restored", adder.getEntityCount(), adder.getByteCount(), String(), startTime);
+}
+
+bool_t Client::scanRange(int64_t fromTime, int64_t toTime, bool_t (*handleEntity)(void_t* userData, const zlimdb_entity& entity), void_t* userData)
+{
+  // start after the last indexed entity that is older than the lower bound
+  TimeIndex::Table& index = timeIndex.getTable(selectedTable);
+  uint64_t sinceId = index.findSinceId(fromTime);
+
+  // a query cannot be canceled, so a bounded query runs on a connection of its own that is dropped once the upper bound has been passed
+  Connection rangeConnection;
+  zlimdb* zdb = this->zdb;
+  if(toTime != 0x7fffffffffffffffLL)
+  {
+    if(!rangeConnection.open(userName, password, address))
+      return Console::errorf("error: Could not establish connection: %s\n", (const char_t*)rangeConnection.getLastError()), false;
+    zdb = rangeConnection;
+  }
+  if(zlimdb_query(zdb, selectedTable, sinceId ? zlimdb_query_type_since_id : zlimdb_query_type_all, sinceId) != 0)
+    return countError(), Console::errorf("error: Could not send query: %s\n", (const char_t*)Connection::getZlimdbError()), false;
+  measureSent();
+  char_t buffer[ZLIMDB_MAX_MESSAGE_SIZE];
+  bool_t passed = false;
+  while(!passed && zlimdb_get_response(zdb, (zlimdb_header*)buffer, ZLIMDB_MAX_MESSAGE_SIZE) == 0)
+  {
+    measureResponse(buffer);
+    for(const zlimdb_entity* entity = zlimdb_get_first_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity));
+        entity;
+        entity = zlimdb_get_next_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity), entity))
+    {
+      index.add(*entity);
+      if(passed || (int64_t)entity->time < fromTime)
+        continue;
+      if((int64_t)entity->time > toTime || !handleEntity(userData, *entity))
+        passed = true;
+    }
+  }
+  if(!passed && zlimdb_errno() != zlimdb_local_error_none)
+    return countError(), Console::errorf("error: Could not receive query response: %s\n", (const char_t*)Connection::getZlimdbError()), false;
+  return true;
+}
+
+void_t Client::queryRange(int64_t fromTime, int64_t toTime)
+{
+  scanRange(fromTime, toTime, writeRangeEntity, this);
+}
+
+void_t Client::queryAggregate(Aggregator& aggregator)
+{
+  // like a range query, but each entity is folded into the open time bucket and only finished buckets are printed
+  Console::printf("%14s %10s %10s %8s %8s %8s %12s %12s\n", "time", "count", "bytes", "avgSize", "minSize", "maxSize", "firstId", "lastId");
+  if(!scanRange(aggregator.getFromTime(), aggregator.getToTime(), aggregateEntity, &aggregator))
+    return;
+  aggregator.flush();
+  if(aggregator.getLateCount())
+    Console::printf("%llu entities were older than their bucket and counted in a later one\n", aggregator.getLateCount());
+}
+
+void_t Client::printBucket(void_t* userData, const Aggregator::Bucket& bucket)
+{
+  Console::printf("%14lld %10llu %10llu %8.1f %8u %8u %12llu %12llu\n", bucket.startTime, bucket.count, bucket.sizeSum,
+    (double)bucket.sizeSum / (double)bucket.count, bucket.minSize, bucket.maxSize, bucket.firstId, bucket.lastId);
+}
+
+void_t Client::aggregate(int64_t window, int64_t fromTime, int64_t toTime)
+{
+  if(!keepRunning)
+    return;
+  enqueueAction(aggregateAction, 0, 0, String(), String(), new Aggregator(window, fromTime, toTime, printBucket, this));
+}
+
+void_t Client::queryHead(uint64_t count)
+{
+  if(!count)
+    return;
+
+  // the connection is dropped as soon as enough entities have been received, so the rest of the table is never transferred
+  Connection headConnection;
+  if(!headConnection.open(userName, password, address))
+    return Console::errorf("error: Could not establish connection: %s\n", (const char_t*)headConnection.getLastError()), (void)0;
+  if(zlimdb_query(headConnection, selectedTable, zlimdb_query_type_all, 0) != 0)
+    return countError(), Console::errorf("error: Could not send query: %s\n", (const char_t*)Connection::getZlimdbError()), (void)0;
+  measureSent();
+  TimeIndex::Table& index = timeIndex.getTable(selectedTable);
+  char_t buffer[ZLIMDB_MAX_MESSAGE_SIZE];
+  uint64_t received = 0;
+  while(zlimdb_get_response(headConnection, (zlimdb_header*)buffer, ZLIMDB_MAX_MESSAGE_SIZE) == 0)
+  {
+    measureResponse(buffer);
+    for(const zlimdb_entity* entity = zlimdb_get_first_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity));
+        entity && received < count;
+        entity = zlimdb_get_next_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity), entity), ++received)
+    {
+      index.add(*entity);
+      writeEntity(*entity);
+    }
+    if(received == count)
+      return;
+  }
+  if(zlimdb_errno() != zlimdb_local_error_none)
+    return countError(), Console::errorf("error: Could not receive query response: %s\n", (const char_t*)Connection::getZlimdbError()), (void)0;
+}
+
+bool_t Client::probeSince(Connection& probeConnection, uint32_t tableId, uint64_t sinceId, uint64_t limit, Buffer& entities, Array<size_t>& offsets, bool_t& aborted)
+{
+  if(!probeConnection.isOpen() && !probeConnection.open(userName, password, address))
+    return Console::errorf("error: Could not establish connection: %s\n", (const char_t*)probeConnection.getLastError()), false;
+  entities.resize(0);
+  offsets.clear();
+  aborted = false;
+  if(zlimdb_query(probeConnection, tableId, sinceId ? zlimdb_query_type_since_id : zlimdb_query_type_all, sinceId) != 0)
+    return countError(), Console::errorf("error: Could not send query: %s\n", (const char_t*)Connection::getZlimdbError()), false;
+  measureSent();
+  TimeIndex::Table& index = timeIndex.getTable(tableId);
+  char_t buffer[ZLIMDB_MAX_MESSAGE_SIZE];
+  while(zlimdb_get_response(probeConnection, (zlimdb_header*)buffer, ZLIMDB_MAX_MESSAGE_SIZE) == 0)
+  {
+    measureResponse(buffer);
+    for(const zlimdb_entity* entity = zlimdb_get_first_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity));
+        entity;
+        entity = zlimdb_get_next_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity), entity))
+    {
+      index.add(*entity);
+      offsets.append(entities.size());
+      entities.append((const byte_t*)entity, entity->size);
+    }
+    if(offsets.size() > limit)
+    {
+      // too many entities after this id, drop the connection instead of receiving the rest
+      aborted = true;
+      probeConnection.close();
+      return true;
+    }
+  }
+  if(zlimdb_errno() != zlimdb_local_error_none)
+    return countError(), Console::errorf("error: Could not receive query response: %s\n", (const char_t*)Connection::getZlimdbError()), false;
+  return true;
+}
+
+void_t Client::queryTail(uint64_t count)
+{
+  if(!count)
+    return;
+  Buffer entities;
+  Array<size_t> offsets;
+  if(!findTail(count, entities, offsets))
+    return;
+  size_t first = offsets.size() > count ? offsets.size() - (size_t)count : 0;
+  for(size_t i = first; i < offsets.size(); ++i)
+  {
+    const zlimdb_entity* entity = (const zlimdb_entity*)((const byte_t*)entities + offsets[i]);
+    writeEntity(*entity);
+  }
+}
+
+bool_t Client::findTail(uint64_t count, Buffer& entities, Array<size_t>& offsets)
+{
+  // search for an id with at least count but not much more than count entities after it, probes that would return too many entities are aborted
+  const uint64_t maxId = 0x7fffffffffffffffULL;
+  const uint64_t limit = count * 2 + 1;
+  uint64_t low = 0, high = maxId;
+  uint64_t step = limit;
+  uint64_t lastId = timeIndex.getTable(selectedTable).getLastId();
+  uint64_t probeId = lastId > count ? lastId - count : 0;
+  Connection probeConnection;
+  for(uint_t probes = 0;; ++probes)
+  {
+    bool_t aborted;
+    if(!probeSince(probeConnection, selectedTable, probeId, limit, entities, offsets, aborted))
+      return false;
+    if(!aborted && (offsets.size() >= count || probeId == 0))
+      break;
+    if(probes == 128)
+      return Console::errorf("error: Could not find the end of the table, it grows faster than the search converges\n"), false;
+    if(aborted)
+    {
+      low = probeId;
+      if(high == maxId)
+      {
+        probeId = maxId - low > step ? low + step : maxId;
+        step = step > maxId / 2 ? maxId : step * 2;
+      }
+      else
+        probeId = low + (high - low) / 2;
+    }
+    else
+    {
+      high = probeId;
+      probeId = low + (high - low) / 2;
+    }
+  }
+  return true;
+}
+
+void_t Client::importShardFile(const String& fileName, bool_t sized, const String& name, uint_t shards, bool_t keyRouting)
+{
+  Array<uint32_t> tableIds;
+  if(!findShards(name, shards, true, tableIds))
+    return;
+  ShardedWriter writer(keyRouting ? ShardedWriter::keyRouting : ShardedWriter::roundRobinRouting);
+  if(!writer.start(userName, password, address, tableIds))
+    return Console::errorf("error: Could not establish connection: %s\n", (const char_t*)writer.getLastError()), (void)0;
+  importFile(fileName, sized, shards, &writer);
+}
+
+bool_t Client::findShards(const String& name, uint_t shards, bool_t create, Array<uint32_t>& tableIds)
+{
+  tableIds.resize(shards);
+  for(uint_t i = 0; i < shards; ++i)
+  {
+    String shardName = ShardedWriter::getShardName(name, i);
+    if(tableCache.isLoaded() && tableCache.find(shardName, tableIds[i]))
+      continue;
+    if(zlimdb_find_table(zdb, shardName, &tableIds[i]) == 0)
+      continue;
+    if(!create)
+      return Console::errorf("error: Could not find table %s\n", (const char_t*)shardName), false;
+    if(zlimdb_add_table(zdb, shardName, &tableIds[i]) != 0)
+      return countError(), Console::errorf("error: Could not create table %s: %s\n", (const char_t*)shardName, (const char_t*)Connection::getZlimdbError()), false;
+  }
+  return true;
+}
+
+void_t Client::readShards(const String& name, uint_t shards)
+{
+  Array<uint32_t> tableIds;
+  if(!findShards(name, shards, false, tableIds))
+    return;
+
+  // every shard is time ordered, so without a reorder window the merger emits up to the least progressed open shard
+  TimeMerger merger(shards, 0x7fffffffffffffffLL, writeMergedEntity, this);
+  Connection* connections = new Connection[shards];
+  Array<uint_t> open;
+  for(uint_t i = 0; i < shards; ++i)
+  {
+    if(!connections[i].open(userName, password, address))
+      return Console::errorf("error: Could not establish connection: %s\n", (const char_t*)connections[i].getLastError()), delete[] connections;
+    if(zlimdb_query(connections[i], tableIds[i], zlimdb_query_type_all, 0) != 0)
+      return countError(), Console::errorf("error: Could not send query: %s\n", (const char_t*)Connection::getZlimdbError()), delete[] connections;
+    open.append(i);
+  }
+  measureSent();
+
+  // read from the shard that holds the merge back, so only a few blocks per shard are buffered
+  char_t buffer[ZLIMDB_MAX_MESSAGE_SIZE];
+  while(!open.isEmpty())
+  {
+    size_t next = 0;
+    for(size_t i = 0; i < open.size(); ++i)
+    {
+      uint_t shard = open[i];
+      if(!merger.hasSeen(shard))
+      {
+        next = i;
+        break;
+      }
+      if(merger.getInputTime(shard) < merger.getInputTime(open[next]))
+        next = i;
+    }
+    uint_t shard = open[next];
+    if(zlimdb_get_response(connections[shard], (zlimdb_header*)buffer, ZLIMDB_MAX_MESSAGE_SIZE) == 0)
+    {
+      measureResponse(buffer);
+      const zlimdb_entity* entity = zlimdb_get_first_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity));
+      if(entity)
+        merger.add(shard, entity, buffer + ((const zlimdb_header*)buffer)->size - (const char_t*)entity);
+      continue;
+    }
+    if(zlimdb_errno() != zlimdb_local_error_none)
+    {
+      countError(), Console::errorf("error: Could not receive query response: %s\n", (const char_t*)Connection::getZlimdbError());
+      break;
+    }
+    merger.close(shard);
+    open.remove(next);
+  }
+  merger.flush();
+  delete[] connections;
+  Console::printf("merged %llu entities from %u shards\n", merger.getEmittedCount(), shards);
+}
+
+void_t Client::startPing(uint_t count, uint_t interval)
+{
+  // the samples are taken between other actions, so a long series does not hold back the worker
+  stopPing();
+  if(!count)
+    return;
+  activePing = new Ping(selectedTable, count, interval);
+  samplePing();
+}
+
+void_t Client::samplePing()
+{
+  int64_t serverTime, tableTime;
+  int64_t localTime = Time::time();
+  int64_t start = Time::microTicks();
+  if(zlimdb_sync(zdb, activePing->getTableId(), &serverTime, &tableTime))
+  {
+    countError(), Console::errorf("error: Could not send sync request: %s\n", (const char_t*)Connection::getZlimdbError());
+    return stopPing();
+  }
+  activePing->add(localTime, Time::microTicks() - start, serverTime, tableTime, Time::ticks());
+  if(activePing->isDone())
+    stopPing();
+}
+
+void_t Client::stopPing()
+{
+  if(activePing)
+  {
+    activePing->printSummary();
+    delete activePing;
+    activePing = 0;
+  }
+  if(pingDrained)
+  {
+    pingDrained->set();
+    pingDrained = 0;
+  }
+}
+
+bool_t Client::computeChecksum(uint32_t tableId, Checksum& checksum)
+{
+  if(!checksum.start())
+    return Console::errorf("error: Could not start checksum threads: %s\n", (const char_t*)Error::getErrorString()), false;
+  if(zlimdb_query(zdb, tableId, zlimdb_query_type_all, 0) != 0)
+    return countError(), Console::errorf("error: Could not send query: %s\n", (const char_t*)Connection::getZlimdbError()), false;
+  measureSent();
+  char_t buffer[ZLIMDB_MAX_MESSAGE_SIZE];
+  while(zlimdb_get_response(zdb, (zlimdb_header*)buffer, ZLIMDB_MAX_MESSAGE_SIZE) == 0)
+  {
+    measureResponse(buffer);
+    const zlimdb_entity* entity = zlimdb_get_first_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity));
+    if(entity)
+      checksum.add(entity, buffer + ((const zlimdb_header*)buffer)->size - (const char_t*)entity);
+  }
+  if(zlimdb_errno() != zlimdb_local_error_none)
+    return countError(), Console::errorf("error: Could not receive query response: %s\n", (const char_t*)Connection::getZlimdbError()), false;
+  checksum.finish();
+  return true;
+}
+
+void_t Client::printChecksum(const String& table)
+{
+  uint32_t tableId;
+  if(!resolveTable(table, tableId))
+    return;
+  int64_t start = Time::microTicks();
+  Checksum checksum;
+  if(!computeChecksum(tableId, checksum))
+    return;
+  Console::printf("checksum table %u: %llu entities in %u ranges, hash %016llx, %.3f s\n", tableId, checksum.getEntityCount(),
+    (uint_t)checksum.getRanges().size(), checksum.getHash(), (double)(Time::microTicks() - start) / 1000000.);
+}
+
+void_t Client::diffTables(const String& table, const String& otherTable)
+{
+  uint32_t tableId, otherTableId;
+  if(!resolveTable(table, tableId) || !resolveTable(otherTable, otherTableId))
+    return;
+  Checksum checksum, otherChecksum;
+  if(!computeChecksum(tableId, checksum) || !computeChecksum(otherTableId, otherChecksum))
+    return;
+
+  // only ranges with different hashes are fetched again from both tables
+  const Array<Checksum::Range>& ranges = checksum.getRanges();
+  const Array<Checksum::Range>& otherRanges = otherChecksum.getRanges();
+  uint64_t rangeSize = checksum.getRangeSize();
+  Array<uint64_t> differentRanges;
+  for(size_t i = 0, j = 0; i < ranges.size() || j < otherRanges.size();)
+  {
+    const Checksum::Range* range = i < ranges.size() ? &ranges[i] : 0;
+    const Checksum::Range* otherRange = j < otherRanges.size() ? &otherRanges[j] : 0;
+    if(range && otherRange)
+    {
+      if(range->firstId < otherRange->firstId)
+        otherRange = 0;
+      else if(otherRange->firstId < range->firstId)
+        range = 0;
+      else if(range->count == otherRange->count && range->hash == otherRange->hash)
+      {
+        ++i, ++j;
+        continue;
+      }
+    }
+    if(range)
+      ++i;
+    if(otherRange)
+      ++j;
+    differentRanges.append(range ? range->firstId : otherRange->firstId);
+  }
+  if(differentRanges.isEmpty())
+  {
+    Console::printf("diff: tables %u and %u are identical, %llu entities, hash %016llx\n", tableId, otherTableId, checksum.getEntityCount(), checksum.getHash());
+    return;
+  }
+
+  // both tables are scanned once from the first different range on, over one connection
+  Connection probeConnection;
+  Map<uint64_t, uint64_t> hashes, otherHashes;
+  if(!hashRanges(probeConnection, tableId, differentRanges, rangeSize, hashes) ||
+     !hashRanges(probeConnection, otherTableId, differentRanges, rangeSize, otherHashes))
+    return;
+  uint64_t differences = 0;
+  Map<uint64_t, uint64_t>::Iterator i = hashes.begin(), end = hashes.end();
+  Map<uint64_t, uint64_t>::Iterator j = otherHashes.begin(), otherEnd = otherHashes.end();
+  while(i != end || j != otherEnd)
+  {
+    if(j == otherEnd || (i != end && i.key() < j.key()))
+    {
+      Console::printf("diff: id %llu only in table %u\n", i.key(), tableId);
+      ++differences;
+      ++i;
+    }
+    else if(i == end || j.key() < i.key())
+    {
+      Console::printf("diff: id %llu only in table %u\n", j.key(), otherTableId);
+      ++differences;
+      ++j;
+    }
+    else
+    {
+      if(*i != *j)
+      {
+        Console::printf("diff: id %llu differs\n", i.key());
+        ++differences;
+      }
+      ++i, ++j;
+    }
+  }
+  Console::printf("diff: %llu ids differ in %u of %u ranges\n", differences, (uint_t)differentRanges.size(), (uint_t)(ranges.size() > otherRanges.size() ? ranges.size() : otherRanges.size()));
+}
+
+bool_t Client::hashRanges(Connection& probeConnection, uint32_t tableId, const Array<uint64_t>& rangeIds, uint64_t rangeSize, Map<uint64_t, uint64_t>& hashes)
+{
+  if(!probeConnection.isOpen() && !probeConnection.open(userName, password, address))
+    return Console::errorf("error: Could not establish connection: %s\n", (const char_t*)probeConnection.getLastError()), false;
+  uint64_t sinceId = rangeIds[0] ? rangeIds[0] - 1 : 0;
+  if(zlimdb_query(probeConnection, tableId, sinceId ? zlimdb_query_type_since_id : zlimdb_query_type_all, sinceId) != 0)
+    return countError(), Console::errorf("error: Could not send query: %s\n", (const char_t*)Connection::getZlimdbError()), false;
+  measureSent();
+  char_t buffer[ZLIMDB_MAX_MESSAGE_SIZE];
+  size_t range = 0;
+  while(zlimdb_get_response(probeConnection, (zlimdb_header*)buffer, ZLIMDB_MAX_MESSAGE_SIZE) == 0)
+  {
+    // the query is read to its end, so the connection can be used for the next one
+    measureResponse(buffer);
+    for(const zlimdb_entity* entity = zlimdb_get_first_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity));
+        entity;
+        entity = zlimdb_get_next_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity), entity))
+    {
+      while(range < rangeIds.size() && entity->id >= rangeIds[range] + rangeSize)
+        ++range;
+      if(range < rangeIds.size() && entity->id >= rangeIds[range])
+        hashes.append(entity->id, Checksum::hashEntity(*entity));
+    }
+  }
+  if(zlimdb_errno() != zlimdb_local_error_none)
+    return countError(), Console::errorf("error: Could not receive query response: %s\n", (const char_t*)Connection::getZlimdbError()), false;
+  return true;
+}
+
+void_t Client::queryParallel(uint_t connections, const String& fileName)
+{
+  // the id space is split at the last id, so the tail of the table is probed first
+  uint64_t lastId = 0;
+  {
+    Buffer entities;
+    Array<size_t> offsets;
+    if(!findTail(1, entities, offsets))
+      return;
+    if(offsets.isEmpty())
+      return;
+    lastId = ((const zlimdb_entity*)((const byte_t*)entities + offsets.back()))->id;
+  }
+
+  BlockFile file;
+  if(!fileName.isEmpty() && !file.create(fileName))
+    return Console::errorf("error: Could not create file %s: %s\n", (const char_t*)fileName, (const char_t*)file.getLastError()), (void)0;
+  int64_t startTime = Time::microTicks();
+  ParallelQuery query;
+  if(!query.start(userName, password, address, selectedTable, lastId, connections, fileName.isEmpty()))
+    return Console::errorf("error: Could not start query: %s\n", (const char_t*)query.getLastError()), (void)0;
+  measureSent();
+  TimeIndex::Table& index = timeIndex.getTable(selectedTable);
+  uint64_t count = 0;
+  for(const zlimdb_header* block; (block = query.read());)
+  {
+    measureResponse(block);
+    if(!fileName.isEmpty())
+    {
+      // ranges complete in any order when writing to a file
+      for(const zlimdb_entity* entity = zlimdb_get_first_entity((zlimdb_header*)block, sizeof(zlimdb_entity));
+          entity;
+          entity = zlimdb_get_next_entity((zlimdb_header*)block, sizeof(zlimdb_entity), entity))
+        ++count;
+      if(!file.write(*block))
+        return Console::errorf("error: Could not write to file %s: %s\n", (const char_t*)fileName, (const char_t*)file.getLastError()), (void)0;
+      continue;
+    }
+    for(const zlimdb_entity* entity = zlimdb_get_first_entity((zlimdb_header*)block, sizeof(zlimdb_entity));
+        entity;
+        entity = zlimdb_get_next_entity((zlimdb_header*)block, sizeof(zlimdb_entity), entity), ++count)
+    {
+      index.add(*entity);
+      writeEntity(*entity);
+    }
+  }
+  if(!query.getLastError().isEmpty())
+    return Console::errorf("error: Could not receive query response: %s\n", (const char_t*)query.getLastError()), (void)0;
+  if(fileName.isEmpty())
+    return;
+  file.close();
+  String details;
+  details.printf(", %llu compressed, %u connections", file.getCompressedSize(), connections);
+  printTransfer("exported", count, file.getRawSize(), details, startTime);
+}
+
+void_t Client::printTransfer(const char_t* verb, uint64_t count, uint64_t bytes, const String& details, int64_t startTime)
+{
+  double duration = (double)(Time::microTicks() - startTime) / 1000000.;
+  if(duration <= 0.)
+    duration = 0.000001;
+  Console::printf("%s %llu entities (%llu bytes%s) in %.3f s, %.0f entities/s, %.2f MB/s\n", verb, count, bytes, (const char_t*)details, duration,
+    (double)count / duration, (double)bytes / duration / (1024. * 1024.));
+}
+
+bool_t Client::isCompressed(uint32_t tableId)
+{
+  compressionMutex.lock();
+  bool_t result = compressedTables.contains(tableId);
+  compressionMutex.unlock();
+  return result;
+}
+
+void_t Client::writeEntity(const zlimdb_entity& entity)
+{
+  if(compressedTables.contains(selectedTable))
+    output.writeEntity(*codec.decompress(entity));
+  else
+    output.writeEntity(entity);
+}
+
+void_t Client::showCompression()
+{
+  uint64_t rawBytes = codec.getRawBytes(), encodedBytes = codec.getEncodedBytes();
+  int64_t compressTime = codec.getCompressTime(), decompressTime = codec.getDecompressTime();
+  for(Array<Lane*>::Iterator i = lanes.begin(), end = lanes.end(); i != end; ++i)
+  {
+    const PayloadCodec& laneCodec = (*i)->codec;
+    rawBytes += laneCodec.getRawBytes();
+    encodedBytes += laneCodec.getEncodedBytes();
+    compressTime += laneCodec.getCompressTime();
+    decompressTime += laneCodec.getDecompressTime();
+  }
+  for(HashMap<uint32_t, Subscription*>::Iterator i = subscriptions.begin(), end = subscriptions.end(); i != end; ++i)
+    if((*i)->getHandler() == printUpdate)
+      decompressTime += ((const Printer*)(*i)->getUserData())->codec.getDecompressTime();
+  String tables;
+  for(HashSet<uint32_t>::Iterator i = compressedTables.begin(), end = compressedTables.end(); i != end; ++i)
+  {
+    String tableId;
+    tableId.printf(tables.isEmpty() ? "%u" : ",%u", *i);
+    tables += tableId;
+  }
+  Console::printf("tables=%s, raw=%llu bytes, compressed=%llu bytes, ratio=%.2f, compress=%.3f s, decompress=%.3f s\n",
+    tables.isEmpty() ? "none" : (const char_t*)tables, rawBytes, encodedBytes, encodedBytes ? (double)rawBytes / (double)encodedBytes : 0.,
+    (double)compressTime / 1000000., (double)decompressTime / 1000000.);
+}
+
+bool_t Client::loadTables()
+{
+  // the subscription delivers all tables first and keeps the cache current with add and remove updates afterwards
+  if(zlimdb_subscribe(zdb, zlimdb_table_tables, zlimdb_query_type_all, 0, zlimdb_subscribe_flag_none) != 0)
+    return false;
+  char_t buffer[ZLIMDB_MAX_MESSAGE_SIZE];
+  while(zlimdb_get_response(zdb, (zlimdb_header*)buffer, ZLIMDB_MAX_MESSAGE_SIZE) == 0)
+    for(const zlimdb_table_entity* table = (const zlimdb_table_entity*)zlimdb_get_first_entity((zlimdb_header*)buffer, sizeof(zlimdb_table_entity));
+        table;
+        table = (const zlimdb_table_entity*)zlimdb_get_next_entity((zlimdb_header*)buffer, sizeof(zlimdb_table_entity), &table->entity))
+      tableCache.add(*table);
+  if(zlimdb_errno() != zlimdb_local_error_none)
+    return tableCache.clear(), false;
+  tableCache.setLoaded();
+  return true;
+}
+
+bool_t Client::findTableId(const String& name, uint32_t& tableId)
+{
+  if(tableCache.isLoaded())
+  {
+    if(!tableCache.find(name, tableId))
+      return Console::errorf("error: Could not find table %s\n", (const char_t*)name), false;
+    return true;
+  }
+  if(zlimdb_find_table(zdb, name, &tableId) != 0)
+    return countError(), Console::errorf("error: Could not send find request: %s\n", (const char_t*)Connection::getZlimdbError()), false;
+  return true;
+}
+
+bool_t Client::resolveTable(const String& table, uint32_t& tableId)
+{
+  if(table.isEmpty())
+    return tableId = selectedTable, true;
+  if(String::isDigit(*(const char_t*)table))
+    return tableId = table.toUInt(), true;
+  return findTableId(table, tableId);
+}
+
+void_t Client::writeTable(const zlimdb_table_entity& table, bool_t userNames)
+{
+  if(sizeof(zlimdb_table_entity) + table.name_size > table.entity.size)
+    return;
+  const char_t* name = (const char_t*)(&table + 1);
+  if(!userNames)
+    return output.writeTable(table.entity, name, table.name_size);
+  const char_t* nameEnd = name + table.name_size;
+  if(table.name_size < 6 || Memory::compare(name, "users/", 6) != 0)
+    return;
+  name += 6;
+  const char_t* userNameEnd = name;
+  while(userNameEnd < nameEnd && *userNameEnd != '/')
+    ++userNameEnd;
+  output.writeTable(table.entity, name, userNameEnd - name);
+}
+
+void_t Client::startMirror(uint32_t tableId, const String& dir)
+{
+  if(mirrors.contains(tableId))
+    return Console::errorf("error: Table %u is already mirrored\n", tableId), (void)0;
+  Mirror* mirror = new Mirror;
+  if(!mirror->open(dir, tableId))
+  {
+    Console::errorf("error: Could not open mirror of table %u: %s\n", tableId, (const char_t*)mirror->getLastError());
+    delete mirror;
+    return;
+  }
+
+  uint64_t count = mirror->getEntityCount();
+  mirrors.append(tableId, mirror);
+  if(!subscribeMirror(*mirror))
+  {
+    mirrors.remove(tableId);
+    delete mirror;
+    return;
+  }
+  // the catch up is flushed as a checkpoint, live updates are written back by the system or when the mirror stops
+  if(!mirror->getLastError().isEmpty() || !mirror->sync())
+    Console::errorf("error: Could not write mirror of table %u: %s\n", tableId, (const char_t*)mirror->getLastError());
+  Console::printf("mirror %s: %llu entities (%llu new), lastId=%llu\n", (const char_t*)mirror->getFileName(),
+    mirror->getEntityCount(), mirror->getEntityCount() - count, mirror->getLastId());
+}
+
+bool_t Client::subscribeMirror(Mirror& mirror)
+{
+  // the subscription first delivers everything after the last mirrored entity and then keeps sending live updates
+  uint32_t tableId = mirror.getTableId();
+  uint64_t lastId = mirror.getLastId();
+  if(zlimdb_subscribe(zdb, tableId, lastId ? zlimdb_query_type_since_id : zlimdb_query_type_all, lastId, zlimdb_subscribe_flag_none) != 0)
+    return countError(), Console::errorf("error: Could not send subscribe request: %s\n", (const char_t*)Connection::getZlimdbError()), false;
+  measureSent();
+  TimeIndex::Table& index = timeIndex.getTable(tableId);
+  char_t buffer[ZLIMDB_MAX_MESSAGE_SIZE];
+  while(zlimdb_get_response(zdb, (zlimdb_header*)buffer, ZLIMDB_MAX_MESSAGE_SIZE) == 0)
+  {
+    measureResponse(buffer);
+    for(const zlimdb_entity* entity = zlimdb_get_first_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity));
+        entity;
+        entity = zlimdb_get_next_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity), entity))
+    {
+      index.add(*entity);
+      if(!mirror.append(*entity))
+        break;
+    }
+  }
+  if(zlimdb_errno() != zlimdb_local_error_none)
+    return countError(), Console::errorf("error: Could not receive subscribe response: %s\n", (const char_t*)Connection::getZlimdbError()), false;
+  return true;
+}
+
+void_t Client::stopMirrors()
+{
+  for(HashMap<uint32_t, Mirror*>::Iterator i = mirrors.begin(), end = mirrors.end(); i != end; ++i)
+  {
+    Mirror* mirror = *i;
+    if(!mirror->sync())
+      Console::errorf("error: Could not write mirror of table %u: %s\n", i.key(), (const char_t*)mirror->getLastError());
+    delete mirror;
+  }
+  mirrors.clear();
+}
+
+void_t Client::startReplication(Replicator* replicator)
+{
+  deleteReplications(false);
+  if(!replicator->start(userName, password))
+  {
+    Console::errorf("error: Could not start replication %s: %s\n", (const char_t*)replicator->getName(), (const char_t*)replicator->getLastError());
+    delete replicator;
+    return;
+  }
+  replicators.append(replicator);
+}
+
+void_t Client::deleteReplications(bool_t all)
+{
+  // finished replications are collected whenever another one is started
+  for(List<Replicator*>::Iterator i = replicators.begin(), end = replicators.end(); i != end;)
+  {
+    Replicator* replicator = *i;
+    if(all || !replicator->isRunning())
+    {
+      delete replicator;
+      i = replicators.remove(i);
+    }
+    else
+      ++i;
+  }
+}
+
+void_t Client::startSubscription(Subscription* subscription)
+{
+  uint32_t tableId = subscription->getTableId();
+  if(subscriptions.contains(tableId))
+    return Console::errorf("error: Table %u is already subscribed\n", tableId), deleteSubscription(subscription);
+  if(!subscription->start())
+    return Console::errorf("error: Could not start subscription thread: %s\n", (const char_t*)Error::getErrorString()), deleteSubscription(subscription);
+
+  // register before receiving the initial entities, since updates may be interleaved with the subscribe responses
+  subscriptions.append(tableId, subscription);
+  if(!subscribeTable(*subscription))
+  {
+    subscriptions.remove(tableId);
+    deleteSubscription(subscription);
+  }
+}
+
+bool_t Client::subscribeTable(Subscription& subscription)
+{
+  uint32_t tableId = subscription.getTableId();
+  uint64_t sinceId = subscription.getReceivedId();
+  if(zlimdb_subscribe(zdb, tableId, sinceId ? zlimdb_query_type_since_id : zlimdb_query_type_all, sinceId, zlimdb_subscribe_flag_none) != 0)
+    return countError(), Console::errorf("error: Could not send subscribe request: %s\n", (const char_t*)Connection::getZlimdbError()), false;
+  measureSent();
+  char_t buffer[ZLIMDB_MAX_MESSAGE_SIZE];
+  TimeIndex::Table& index = timeIndex.getTable(tableId);
+  while(zlimdb_get_response(zdb, (zlimdb_header*)buffer, ZLIMDB_MAX_MESSAGE_SIZE) == 0)
+  {
+    measureResponse(buffer);
+    const zlimdb_header* header = (const zlimdb_header*)buffer;
+    const zlimdb_entity* first = zlimdb_get_first_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity));
+    if(!first)
+      continue;
+    for(const zlimdb_entity* entity = first; entity; entity = zlimdb_get_next_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity), entity))
+      index.add(*entity);
+    subscription.push(first, buffer + header->size - (const char_t*)first);
+  }
+  if(zlimdb_errno() != zlimdb_local_error_none)
+    return countError(), Console::errorf("error: Could not receive subscribe response: %s\n", (const char_t*)Connection::getZlimdbError()), false;
+  return true;
+}
+
+void_t Client::deleteSubscription(Subscription* subscription)
+{
+  subscription->stop();
+  if(subscription->getHandler() == printUpdate)
+    delete (Printer*)subscription->getUserData();
+  else if(subscription->getHandler() == Merge::handleUpdate)
+  {
+    // the entities held back for the reorder window are written once the last input of a merge is gone
+    Merge* merge = Merge::getMerge(subscription->getUserData());
+    if(!merge->close(subscription->getUserData()))
+    {
+      merge->flush();
+      merges.remove(merges.find(merge));
+      delete merge;
+    }
+  }
+  delete subscription;
+}
+
+void_t Client::stopSubscriptions()
+{
+  for(HashMap<uint32_t, Subscription*>::Iterator i = subscriptions.begin(), end = subscriptions.end(); i != end; ++i)
+    deleteSubscription(*i);
+  subscriptions.clear();
+  for(List<Merge*>::Iterator i = merges.begin(), end = merges.end(); i != end; ++i)
+  {
+    (*i)->flush();
+    delete *i;
+  }
+  merges.clear();
+}
+
+void_t Client::printUpdate(void_t* userData, const Subscription::Update& update)
+{
+  Printer* printer = (Printer*)userData;
+  for(const zlimdb_entity* entity = update.getFirstEntity(); entity; entity = update.getNextEntity(entity))
+    printer->writer.writeEntity(printer->decompress ? *printer->codec.decompress(*entity) : *entity);
+  if(!update.pending)
+    printer->writer.flush();
+}
+
+void_t Client::startTop(Top* top)
+{
+  stopTop(true);
+  if(top->isEmpty())
+  {
+    if(!tableCache.isLoaded() && !loadTables())
+      return countError(), delete top, Console::errorf("error: Could not load tables: %s\n", (const char_t*)Connection::getZlimdbError()), (void)0;
+    for(TableCache::Iterator i = tableCache.begin(), end = tableCache.end(); i != end; ++i)
+    {
+      const zlimdb_table_entity* table = *i;
+      top->addTable((uint32_t)table->entity.id, String((const char_t*)(table + 1), table->name_size));
+    }
+  }
+  activeTop = top;
+  top->start(Time::ticks());
+  subscribeTop();
+}
+
+bool_t Client::subscribeTop()
+{
+  // the tables are subscribed after their last entity, so only new entities are counted
+  Array<uint32_t> tableIds;
+  activeTop->getTableIds(tableIds);
+  char_t buffer[ZLIMDB_MAX_MESSAGE_SIZE];
+  for(Array<uint32_t>::Iterator i = tableIds.begin(), end = tableIds.end(); i != end; ++i)
+  {
+    uint32_t tableId = *i;
+    if(mirrors.contains(tableId) || subscriptions.contains(tableId))
+      continue;
+    if(zlimdb_subscribe(zdb, tableId, zlimdb_query_type_since_id, 0x7fffffffffffffffULL, zlimdb_subscribe_flag_none) != 0)
+      return countError(), Console::errorf("error: Could not send subscribe request: %s\n", (const char_t*)Connection::getZlimdbError()), false;
+    while(zlimdb_get_response(zdb, (zlimdb_header*)buffer, ZLIMDB_MAX_MESSAGE_SIZE) == 0)
+      ;
+    if(zlimdb_errno() != zlimdb_local_error_none)
+      return countError(), Console::errorf("error: Could not receive subscribe response: %s\n", (const char_t*)Connection::getZlimdbError()), false;
+  }
+  return true;
+}
+
+void_t Client::stopTop(bool_t unsubscribe)
+{
+  if(!activeTop)
+    return;
+  if(unsubscribe)
+  {
+    Array<uint32_t> tableIds;
+    activeTop->getTableIds(tableIds);
+    for(Array<uint32_t>::Iterator i = tableIds.begin(), end = tableIds.end(); i != end; ++i)
+      if(!mirrors.contains(*i) && !subscriptions.contains(*i) && zlimdb_unsubscribe(zdb, *i) != 0)
+        countError(), Console::errorf("error: Could not send unsubscribe request: %s\n", (const char_t*)Connection::getZlimdbError());
+  }
+  delete activeTop;
+  activeTop = 0;
+}
+
+void_t Client::top(const Array<uint32_t>& tableIds)
+{
+  if(!keepRunning)
+    return;
+  Top* top = new Top;
+  for(Array<uint32_t>::Iterator i = tableIds.begin(), end = tableIds.end(); i != end; ++i)
+  {
+    String name;
+    name.printf("%u", *i);
+    top->addTable(*i, name);
+  }
+  enqueueAction(topAction, 0, 0, String(), String(), top);
+}
+
+void_t Client::subscribe(const Array<uint32_t>& tableIds, int64_t window, bool_t drop)
+{
+  if(!keepRunning || tableIds.isEmpty())
+    return;
+  enqueueAction(mergeAction, 0, drop ? subscribeDropFlag : 0, String(), String(), new Merge(tableIds, window));
+}
+
+void_t Client::replicate(const String& sourceAddress, const String& sourceTable, const String& destinationAddress, const String& destinationTable, bool_t follow, uint_t connections)
+{
+  if(!keepRunning)
+    return;
+  enqueueAction(replicateAction, 0, 0, String(), String(), new Replicator(sourceAddress, sourceTable, destinationAddress, destinationTable, follow, connections));
+}
+
+bool_t Client::subscribe(uint32_t tableId, Subscription::Handler handler, void_t* userData, Subscription::Policy policy, uint32_t queueSize)
+{
+  if(!keepRunning)
+    return false;
+  enqueueAction(subscribeAction, tableId, subscribeTableFlag, String(), String(), new Subscription(tableId, handler, userData, policy, queueSize));
+  return true;
+}
+
+void_t Client::enqueueAction(ActionType type, uint64_t param1, uint64_t param2, const String& string1, const String& string2, void_t* userData)
+{
+  if(!keepRunning)
+    return;
+  Action action = {type, param1, param2, acquireStrings(freeActionStrings, string1, string2), Time::microTicks(), 0, 0, userData};
+  pushAction(action);
+}
+
+void_t Client::pushAction(const Action& action)
+{
+  while(!actions.push(action))
+    Thread::yield(); // the queue is full, wait for the worker to catch up
+  if(Atomic::swap(interruptPending, 1) == 0)
+  {
+    // the handle is replaced while the worker reconnects, it drains the queue afterwards
+    connectionMutex.lock();
+    if(zdb)
+      zlimdb_interrupt(zdb);
+    connectionMutex.unlock();
+  }
+}
+
+uint32_t Client::enqueueRequest(ActionType type, uint64_t param1, uint64_t param2, const String& string1, Callback callback, void_t* userData)
+{
+  uint32_t requestId;
+  while((requestId = Atomic::increment(nextRequestId)) == 0)
+    ;
+  if(!keepRunning)
+  {
+    // report the request as failed, so the caller does not wait for a callback that would never come
+    Result result = {requestId, zlimdb_local_error_not_connected, "Not connected", true};
+    if(callback)
+      callback(userData, result);
+    return requestId;
+  }
+  if(lanes.isEmpty())
+  {
+    // without lanes the worker handles the request on its own connection, in order with the other actions
+    requestMutex.lock();
+    pendingRequests.append(requestId);
+    requestMutex.unlock();
+    Action action = {type, param1, param2, acquireStrings(freeActionStrings, string1, String()), Time::microTicks(), requestId, callback, userData};
+    pushAction(action);
+    return requestId;
+  }
+  Action action = {type, param1, param2, acquireStrings(freeRequestStrings, string1, String()), Time::microTicks(), requestId, callback, userData};
+  uint32_t tableId = getRequestTable(type, param1);
+  requestMutex.lock();
+  pendingRequests.append(requestId);
+  if(tableId)
+  {
+    HashMap<uint32_t, uint_t>::Iterator it = pendingTables.find(tableId);
+    if(it == pendingTables.end())
+      pendingTables.append(tableId, 1);
+    else
+      ++*it;
+  }
+  requestMutex.unlock();
+
+  // requests on a table always go to the same lane, so they are handled in order while other tables proceed on other lanes
+  if(tableId)
+  {
+    Lane* lane = lanes[tableId % lanes.size()];
+    while(!lane->requests.push(action))
+      Thread::yield();
+    lane->requestCount.signal();
+    return requestId;
+  }
+
+  // wake every lane for a table agnostic request, the first idle one takes it and busy ones find the queue empty later on
+  while(!requests.push(action))
+    Thread::yield();
+  for(Array<Lane*>::Iterator i = lanes.begin(), end = lanes.end(); i != end; ++i)
+    (*i)->requestCount.signal();
+  return requestId;
+}
+
+Client::ActionStrings* Client::acquireStrings(LockFreeQueue<ActionStrings*>& pool, const String& string1, const String& string2)
+{
+  if(string1.isEmpty() && string2.isEmpty())
+    return 0;
+  ActionStrings* strings;
+  while(!pool.pop(strings))
+    Thread::yield(); // every slot belongs to a queued action, wait for the consumer to catch up
+  strings->string1 = string1;
+  strings->string2 = string2;
+  return strings;
+}
+
+void_t Client::releaseStrings(LockFreeQueue<ActionStrings*>& pool, const Action& action)
+{
+  if(!action.strings)
+    return;
+  action.strings->string1.clear();
+  action.strings->string2.clear();
+  VERIFY(pool.push(action.strings));
+}
+
+void_t Client::cancelRequest(const Action& action)
+{
+  Result result = {action.requestId, zlimdb_local_error_not_connected, "Not connected", true};
+  if(action.callback)
+    action.callback(action.userData, result);
+}
+
+void_t Client::handleRequest(zlimdb* zdb, const Action& action, Buffer& buffer, Stats::Block& stats, PayloadCodec& codec)
+{
+  int64_t start = Time::microTicks();
+  Stats::Counters& counters = stats.counters[action.type];
+  ++counters.count;
+  counters.queueTime += start - action.enqueueTime;
+
+  Result result;
+  result.requestId = action.requestId;
+  result.error = 0;
+  result.complete = false;
+  result.tableId = 0;
+  result.entityId = 0;
+  result.serverTime = result.tableTime = 0;
+  uint32_t tableId = (uint32_t)action.param1;
+  int status = 0;
+  switch(action.type)
+  {
+  case createTableAction:
+    status = zlimdb_add_table(zdb, action.getString1(), &result.tableId);
+    break;
+  case findTableAction:
+    status = zlimdb_find_table(zdb, action.getString1(), &result.tableId);
+    break;
+  case copyTableAction:
+    status = zlimdb_copy_table(zdb, tableId, action.getString1(), &result.tableId);
+    break;
+  case removeTableAction:
+    status = zlimdb_remove(zdb, zlimdb_table_tables, tableId);
+    break;
+  case clearTableAction:
+    status = zlimdb_clear(zdb, tableId);
+    break;
+  case addAction:
+    {
+      const void_t* data = (const char_t*)action.getString1();
+      size_t dataSize = action.getString1().length();
+      if(isCompressed(tableId))
+        data = codec.compress(data, dataSize, BulkAdder::getMaxDataSize(), dataSize);
+      size_t size = sizeof(zlimdb_entity) + dataSize;
+      if(!data || size > ZLIMDB_MAX_MESSAGE_SIZE - sizeof(zlimdb_add_request))
+      {
+        result.error = zlimdb_local_error_invalid_parameter;
+        result.errorString = "Entity too large";
+        break;
+      }
+      zlimdb_entity* entity = (zlimdb_entity*)(byte_t*)buffer;
+      ClientProtocol::setEntityHeader(*entity, 0, action.param2, (uint16_t)size);
+      Memory::copy(entity + 1, data, dataSize);
+      status = zlimdb_add(zdb, tableId, entity, &result.entityId);
+    }
+    break;
+  case queryAction:
+    {
+      zlimdb_query_type queryType = action.param2 ? zlimdb_query_type_since_id : zlimdb_query_type_all;
+      if((status = zlimdb_query(zdb, tableId, queryType, action.param2)) != 0)
+        break;
+      counters.sendTime += Time::microTicks() - start;
+      zlimdb_header* header = (zlimdb_header*)(byte_t*)buffer;
+      bool_t responded = false;
+      while(zlimdb_get_response(zdb, header, ZLIMDB_MAX_MESSAGE_SIZE) == 0)
+      {
+        if(!responded)
+        {
+          responded = true;
+          ++counters.responseCount;
+          counters.firstResponseTime += Time::microTicks() - start;
+        }
+        counters.bytes += header->size;
+        result.entities.clear();
+        for(const zlimdb_entity* entity = zlimdb_get_first_entity(header, sizeof(zlimdb_entity));
+            entity;
+            entity = zlimdb_get_next_entity(header, sizeof(zlimdb_entity), entity))
+          result.entities.append(entity);
+        counters.entities += result.entities.size();
+        if(action.callback)
+          action.callback(action.userData, result);
+      }
+      result.entities.clear();
+      status = zlimdb_errno() != zlimdb_local_error_none;
+    }
+    break;
+  case syncAction:
+    status = zlimdb_sync(zdb, tableId, &result.serverTime, &result.tableTime);
+    break;
+  default:
+    result.error = zlimdb_local_error_invalid_parameter;
+    result.errorString = "Invalid request";
+    break;
+  }
+  if(status != 0)
+  {
+    result.error = zlimdb_errno();
+    result.errorString = Connection::getZlimdbError();
+  }
+  if(result.error)
+    ++counters.errors;
+  result.complete = true;
+  if(action.callback)
+    action.callback(action.userData, result);
+
+  counters.totalTime += Time::microTicks() - start;
+  finishRequest(action);
+}
+
+void_t Client::failRequest(const Action& action, const String& error)
+{
+  Result result = {action.requestId, zlimdb_local_error_not_connected, error, true};
+  if(action.callback)
+    action.callback(action.userData, result);
+  finishRequest(action);
+}
+
+void_t Client::finishRequest(const Action& action)
+{
+  uint32_t tableId = getRequestTable(action.type, action.param1);
+  requestMutex.lock();
+  pendingRequests.remove(action.requestId);
+  if(tableId)
+  {
+    HashMap<uint32_t, uint_t>::Iterator it = pendingTables.find(tableId);
+    if(it != pendingTables.end() && --*it == 0)
+      pendingTables.remove(it);
+  }
+  requestMutex.unlock();
+  requestSignal.set();
+}
+
+void_t Client::wait(uint32_t requestId)
+{
+  for(;;)
+  {
+    requestSignal.reset();
+    requestMutex.lock();
+    bool_t pending = pendingRequests.contains(requestId);
+    requestMutex.unlock();
+    if(!pending)
+      return;
+    requestSignal.wait(10);
+  }
+}
+
+void_t Client::wait()
+{
+  for(;;)
+  {
+    requestSignal.reset();
+    requestMutex.lock();
+    bool_t pending = !pendingRequests.isEmpty();
+    requestMutex.unlock();
+    if(!pending)
+      return;
+    requestSignal.wait(10);
+  }
+}
+
+void_t Client::drain()
+{
+  // actions are handled in order, so everything queued before the marker is done when it is reached
+  Signal drained;
+  enqueueAction(quitAction, 0, 0, String(), String(), &drained);
+  while(keepRunning && !drained.wait(100))
+    ;
+}
+
+void_t Client::zlimdbCallback(const void_t* data)
+{
+  const zlimdb_header* header = (const zlimdb_header*)data;
+  // todo: check sizes
+  switch(header->message_type)
+  {
+  case zlimdb_message_add_request:
+    if(header->size >= sizeof(zlimdb_add_request) + sizeof(zlimdb_entity))
+    {
+      const zlimdb_add_request* addRequest = (const zlimdb_add_request*)header;
+      const zlimdb_entity* entity = (const zlimdb_entity*)(addRequest + 1);
+      if(entity->size < sizeof(zlimdb_entity) || sizeof(zlimdb_add_request) + entity->size > header->size)
+        break;
+      if(addRequest->table_id == zlimdb_table_tables)
+      {
+        if(tableCache.isLoaded() && entity->size >= sizeof(zlimdb_table_entity))
+          tableCache.add(*(const zlimdb_table_entity*)entity);
+        break;
+      }
+      bool_t handled = false;
+      HashMap<uint32_t, Mirror*>::Iterator it = mirrors.find(addRequest->table_id);
+      if(it != mirrors.end())
+      {
+        Mirror* mirror = *it;
+        if(!mirror->append(*entity))
+        {
+          Console::errorf("error: Could not write mirror of table %u: %s\n", mirror->getTableId(), (const char_t*)mirror->getLastError());
+          mirrors.remove(addRequest->table_id);
+          delete mirror;
+        }
+        handled = true;
+      }
+      HashMap<uint32_t, Subscription*>::Iterator sub = subscriptions.find(addRequest->table_id);
+      if(sub != subscriptions.end())
+      {
+        (*sub)->push(entity, header->size - sizeof(zlimdb_add_request));
+        handled = true;
+      }
+      bool_t counted = activeTop && activeTop->add(addRequest->table_id, *entity);
+      if(handled)
+      {
+        timeIndex.getTable(addRequest->table_id).add(*entity);
+        break;
+      }
+      if(counted)
+        break;
+    }
+    Console::printf("subscribe: messageType=%u\n", (uint_t)header->message_type);
+    break;
+  case zlimdb_message_remove_request:
+    if(header->size >= sizeof(zlimdb_remove_request) && ((const zlimdb_remove_request*)header)->table_id == zlimdb_table_tables)
+    {
+      tableCache.remove((uint32_t)((const zlimdb_remove_request*)header)->id);
+      break;
+    }
+    Console::printf("subscribe: messageType=%u\n", (uint_t)header->message_type);
+    break;
+  case zlimdb_message_error_response:
+    {
+      const zlimdb_error_response* errorResponse = (const zlimdb_error_response*)header;
+      Console::printf("subscribe: errorResponse=%s (%d)\n", (const char_t*)Connection::getZlimdbError(), (int)errorResponse->error);
+    }
+    break;
+  default:
+    Console::printf("subscribe: messageType=%u\n", (uint_t)header->message_type);
+    break;
   }
 }
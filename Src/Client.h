@@ -2,39 +2,129 @@
 #pragma once
 
 #include <nstd/Thread.h>
-#include <nstd/Mutex.h>
-#include <nstd/List.h>
 #include <nstd/Buffer.h>
-#include <nstd/Variant.h>
+#include <nstd/Array.h>
+#include <nstd/List.h>
+#include <nstd/HashSet.h>
+#include <nstd/HashMap.h>
+#include <nstd/Map.h>
+#include <nstd/Mutex.h>
+#include <nstd/Signal.h>
+#include <nstd/Semaphore.h>
+#include <nstd/Time.h>
+
+#include <zlimdbprotocol.h>
+
+#include "Tools/LockFreeQueue.h"
+#include "Tools/OutputWriter.h"
+#include "Tools/PayloadCodec.h"
+#include "Tools/Aggregator.h"
+#include "Connection.h"
+#include "TimeIndex.h"
+#include "TableCache.h"
+#include "Subscription.h"
+#include "Checksum.h"
+#include "Stats.h"
 
-typedef struct _zlimdb_ zlimdb;
+class Mirror;
+class Merge;
+class BulkAdder;
+class Replicator;
+class ShardedWriter;
+class Top;
+class Ping;
 
 class Client
 {
+public:
+  struct Result
+  {
+    uint32_t requestId;
+    int error; // local or server error code, 0 on success
+    String errorString;
+    bool_t complete; // a query reports each response block and finally a complete result
+    uint32_t tableId;
+    uint64_t entityId;
+    int64_t serverTime;
+    int64_t tableTime;
+    Array<const zlimdb_entity*> entities; // valid during the callback only
+  };
+
+  typedef void_t (*Callback)(void_t* userData, const Result& result);
+
 public:
   Client();
   ~Client();
 
   String getLastError() const {return error;}
 
-  bool_t connect(const String& userName, const String& password, const String& address);
+  bool_t connect(const String& userName, const String& password, const String& address, uint_t lanes = 0);
 
   void_t disconnect();
 
   void_t listUsers() {enqueueAction(listUsersAction);}
-  void_t addUser(const String& userName, const String& password) {enqueueAction(addUserAction, userName, password);}
+  void_t addUser(const String& userName, const String& password) {enqueueAction(addUserAction, 0, 0, userName, password);}
   void_t listTables() {enqueueAction(listTablesAction);}
-  void_t createTable(const String& name) {enqueueAction(createTableAction, name);}
+  void_t createTable(const String& name) {enqueueAction(createTableAction, 0, 0, name);}
   void_t removeTable() {enqueueAction(removeTableAction);}
   void_t clearTable() {enqueueAction(clearTableAction);}
-  void_t copyTable(const String& newName) {enqueueAction(copyTableAction, newName);}
-  void_t findTable(const String& name) {enqueueAction(findTableAction, name);}
+  void_t copyTable(const String& newName) {enqueueAction(copyTableAction, 0, 0, newName);}
+  void_t findTable(const String& name) {enqueueAction(findTableAction, 0, 0, name);}
   void_t selectTable(uint32_t tableId) {enqueueAction(selectTableAction, tableId);}
+  void_t selectTable(const String& name) {enqueueAction(selectTableAction, 0, 0, name);}
   void_t query() {enqueueAction(queryAction);}
   void_t query(uint64_t sinceId) {enqueueAction(queryAction, sinceId);}
-  void_t add(const String& value) {enqueueAction(addAction, value);}
-  void_t subscribe() {enqueueAction(subscribeAction);}
+  void_t query(int64_t fromTime, int64_t toTime) {enqueueAction(queryRangeAction, fromTime, toTime);}
+  void_t aggregate(int64_t window, int64_t fromTime, int64_t toTime);
+  void_t head(uint64_t count) {enqueueAction(headAction, count);}
+  void_t tail(uint64_t count) {enqueueAction(tailAction, count);}
+  void_t parallelQuery(uint_t connections, const String& file = String()) {enqueueAction(parallelQueryAction, connections, 0, file);}
+  void_t add(const String& value) {enqueueAction(addAction, 0, 0, value);}
+  void_t subscribe(bool_t drop = false) {enqueueAction(subscribeAction, 0, drop ? subscribeDropFlag : 0);}
+  void_t subscribe(uint32_t tableId, bool_t drop) {enqueueAction(subscribeAction, tableId, subscribeTableFlag | (drop ? subscribeDropFlag : 0));}
+  void_t subscribe(const Array<uint32_t>& tableIds, int64_t window, bool_t drop);
+  void_t unsubscribe() {enqueueAction(unsubscribeAction);}
+  void_t unsubscribe(uint32_t tableId) {enqueueAction(unsubscribeAction, tableId, subscribeTableFlag);}
+  void_t listSubscriptions() {enqueueAction(listSubscriptionsAction);}
+  void_t top(const Array<uint32_t>& tableIds);
+  void_t stopTop() {enqueueAction(stopTopAction);}
   void_t sync() {enqueueAction(syncAction);}
+  void_t ping(uint_t count, uint_t interval) {enqueueAction(pingAction, count, interval);}
+  void_t import(const String& file, bool_t sized, uint_t connections) {enqueueAction(importAction, sized, connections, file);}
+  void_t importShards(const String& file, bool_t sized, const String& name, uint_t shards, bool_t keyRouting) {enqueueAction(shardImportAction, shards, (sized ? shardSizedFlag : 0) | (keyRouting ? shardKeyFlag : 0), file, name);}
+  void_t queryShards(const String& name, uint_t shards) {enqueueAction(shardQueryAction, shards, 0, name);}
+  void_t exportTable(const String& file) {enqueueAction(exportAction, 0, 0, file);}
+  void_t exportTable(const String& file, uint64_t sinceId) {enqueueAction(exportAction, sinceId, 0, file);}
+  void_t restore(const String& file, uint_t connections) {enqueueAction(restoreAction, connections, 0, file);}
+  void_t bench(const String& spec) {enqueueAction(benchAction, 0, 0, spec);}
+  void_t mirror(uint32_t tableId, const String& dir) {enqueueAction(mirrorAction, tableId, 0, dir);}
+  void_t replicate(const String& sourceAddress, const String& sourceTable, const String& destinationAddress, const String& destinationTable, bool_t follow, uint_t connections);
+  void_t stopReplications() {enqueueAction(stopReplicationsAction);}
+  void_t checksum(const String& table = String()) {enqueueAction(checksumAction, 0, 0, table);}
+  void_t diff(const String& table, const String& otherTable) {enqueueAction(diffAction, 0, 0, table, otherTable);}
+  void_t dumpStats(const String& file, uint_t interval) {enqueueAction(statsDumpAction, interval, 0, file);}
+  void_t setFormat(OutputWriter::Format format) {enqueueAction(formatAction, format);}
+
+  void_t compress(bool_t enable) {enqueueAction(compressAction, enable ? compressOn : compressOff);}
+  void_t printCompression() {enqueueAction(compressAction, compressShow);}
+
+  void_t printStats();
+  void_t resetStats() {stats.reset();}
+
+  uint32_t createTable(const String& name, Callback callback, void_t* userData = 0) {return enqueueRequest(createTableAction, 0, 0, name, callback, userData);}
+  uint32_t findTable(const String& name, Callback callback, void_t* userData = 0) {return enqueueRequest(findTableAction, 0, 0, name, callback, userData);}
+  uint32_t copyTable(uint32_t tableId, const String& newName, Callback callback, void_t* userData = 0) {return enqueueRequest(copyTableAction, tableId, 0, newName, callback, userData);}
+  uint32_t removeTable(uint32_t tableId, Callback callback, void_t* userData = 0) {return enqueueRequest(removeTableAction, tableId, 0, String(), callback, userData);}
+  uint32_t clearTable(uint32_t tableId, Callback callback, void_t* userData = 0) {return enqueueRequest(clearTableAction, tableId, 0, String(), callback, userData);}
+  uint32_t add(uint32_t tableId, const void_t* data, size_t size, uint64_t time, Callback callback, void_t* userData = 0) {return enqueueRequest(addAction, tableId, time, String((const char_t*)data, size), callback, userData);}
+  uint32_t query(uint32_t tableId, uint64_t sinceId, Callback callback, void_t* userData = 0) {return enqueueRequest(queryAction, tableId, sinceId, String(), callback, userData);}
+  uint32_t sync(uint32_t tableId, Callback callback, void_t* userData = 0) {return enqueueRequest(syncAction, tableId, 0, String(), callback, userData);}
+
+  bool_t subscribe(uint32_t tableId, Subscription::Handler handler, void_t* userData = 0, Subscription::Policy policy = Subscription::blockPolicy, uint32_t queueSize = 256);
+
+  void_t wait(uint32_t requestId);
+  void_t wait();
+  void_t drain();
 
 private:
   enum ActionType
@@ -53,35 +143,242 @@ private:
     addAction,
     subscribeAction,
     syncAction,
+    importAction,
+    exportAction,
+    restoreAction,
+    benchAction,
+    mirrorAction,
+    queryRangeAction,
+    headAction,
+    tailAction,
+    statsDumpAction,
+    formatAction,
+    unsubscribeAction,
+    listSubscriptionsAction,
+    mergeAction,
+    parallelQueryAction,
+    compressAction,
+    replicateAction,
+    stopReplicationsAction,
+    checksumAction,
+    diffAction,
+    pingAction,
+    shardImportAction,
+    shardQueryAction,
+    topAction,
+    stopTopAction,
+    aggregateAction,
+  };
+  enum CompressMode
+  {
+    compressShow,
+    compressOn,
+    compressOff,
+  };
+  enum
+  {
+    mergeInterval = 100,
+    minReconnectDelay = 100,
+    maxReconnectDelay = 30 * 1000,
+  };
+  enum SubscribeFlag
+  {
+    subscribeTableFlag = 0x01,
+    subscribeDropFlag = 0x02,
+  };
+  enum ShardFlag
+  {
+    shardSizedFlag = 0x01,
+    shardKeyFlag = 0x02,
+  };
+  enum
+  {
+    actionQueueSize = 4096,
+    requestQueueSize = 4096,
+  };
+  struct ActionStrings
+  {
+    String string1;
+    String string2;
   };
   struct Action
   {
     ActionType type;
-    Variant param1;
-    Variant param2;
+    uint64_t param1;
+    uint64_t param2;
+    ActionStrings* strings; // taken from a preallocated pool, so queued actions are copied without touching string references
+    int64_t enqueueTime;
+    uint32_t requestId;
+    Callback callback;
+    void_t* userData;
+
+    const String& getString1() const {return strings ? strings->string1 : noString;}
+    const String& getString2() const {return strings ? strings->string2 : noString;}
+  };
+
+  struct Printer
+  {
+    OutputWriter writer;
+    PayloadCodec codec;
+    bool_t decompress;
+  };
+
+  struct RequestPrinter : Printer
+  {
+    ActionType type;
+    String name;
+  };
+
+  class Lane
+  {
+  public:
+    Client* client;
+    Connection connection;
+    Thread thread;
+    LockFreeQueue<Action> requests; // requests on the tables routed to this lane, in order
+    Semaphore requestCount; // signaled for own and for shared requests
+    Stats::Block* stats;
+    PayloadCodec codec;
+
+  public:
+    Lane() : requests(1024) {}
+
+    static uint_t threadProc(void_t* param);
   };
 
 private:
   static uint_t threadProc(void_t* param);
   static void_t zlimdbCallback(void_t* userData, const void_t* data) {((Client*)userData)->zlimdbCallback(data);}
 
-  void_t enqueueAction(ActionType type, const Variant& param1 = Variant(), const Variant& param2 = Variant());
+  void_t enqueueAction(ActionType type, uint64_t param1 = 0, uint64_t param2 = 0, const String& string1 = String(), const String& string2 = String(), void_t* userData = 0);
+  uint32_t enqueueRequest(ActionType type, uint64_t param1, uint64_t param2, const String& string1, Callback callback, void_t* userData);
+  void_t pushAction(const Action& action);
+  void_t cancelRequest(const Action& action);
+  void_t failRequest(const Action& action, const String& error);
+  void_t finishRequest(const Action& action);
+  static ActionStrings* acquireStrings(LockFreeQueue<ActionStrings*>& pool, const String& string1, const String& string2);
+  static void_t releaseStrings(LockFreeQueue<ActionStrings*>& pool, const Action& action);
 
   void_t zlimdbCallback(const void_t* data);
 
   uint8_t process();
+  bool_t reconnect();
+  bool_t restoreSubscriptions();
+  bool_t resumeQuery(uint64_t sinceId);
 
+  void_t handleActions();
   void_t handleAction(const Action& action);
+  void_t dispatchAction(const Action& action);
+  void_t waitForTable(uint32_t tableId);
+  static void_t printResult(void_t* userData, const Result& result);
+  void_t executeAction(const Action& action);
+  void_t handleRequest(zlimdb* zdb, const Action& action, Buffer& buffer, Stats::Block& stats, PayloadCodec& codec);
+
+  void_t measureSent() {if(currentCounters) currentCounters->sendTime += Time::microTicks() - actionStart;}
+  void_t measureResponse(const void_t* data);
+  void_t countError() {if(currentCounters) ++currentCounters->errors;}
+  String formatStats();
+  void_t dumpStats();
+
+  void_t importFile(const String& file, bool_t sized, uint_t connections, ShardedWriter* shards = 0);
+  void_t abortImport(BulkAdder& adder, ShardedWriter* shards);
+  void_t importShardFile(const String& file, bool_t sized, const String& name, uint_t shards, bool_t keyRouting);
+  bool_t findShards(const String& name, uint_t shards, bool_t create, Array<uint32_t>& tableIds);
+  void_t readShards(const String& name, uint_t shards);
+  static void_t writeMergedEntity(void_t* userData, uint_t input, const zlimdb_entity& entity) {((Client*)userData)->writeEntity(entity);}
+  bool_t addRecord(BulkAdder& adder, bool_t compress, const void_t* data, size_t size, int64_t time);
+  void_t exportFile(const String& file, uint64_t sinceId);
+  void_t restoreFile(const String& file, uint_t connections);
+  bool_t scanRange(int64_t fromTime, int64_t toTime, bool_t (*handleEntity)(void_t* userData, const zlimdb_entity& entity), void_t* userData);
+  static bool_t writeRangeEntity(void_t* userData, const zlimdb_entity& entity) {((Client*)userData)->writeEntity(entity); return true;}
+  void_t queryRange(int64_t fromTime, int64_t toTime);
+  static bool_t aggregateEntity(void_t* userData, const zlimdb_entity& entity) {return ((Aggregator*)userData)->add(&entity, entity.size);}
+  void_t queryAggregate(Aggregator& aggregator);
+  static void_t printBucket(void_t* userData, const Aggregator::Bucket& bucket);
+  void_t queryHead(uint64_t count);
+  void_t queryTail(uint64_t count);
+  bool_t findTail(uint64_t count, Buffer& entities, Array<size_t>& offsets);
+  void_t queryParallel(uint_t connections, const String& file);
+  bool_t probeSince(Connection& connection, uint32_t tableId, uint64_t sinceId, uint64_t limit, Buffer& entities, Array<size_t>& offsets, bool_t& aborted);
+  void_t startPing(uint_t count, uint_t interval);
+  void_t samplePing();
+  void_t stopPing();
+  bool_t computeChecksum(uint32_t tableId, Checksum& checksum);
+  void_t printChecksum(const String& table);
+  void_t diffTables(const String& table, const String& otherTable);
+  bool_t hashRanges(Connection& probeConnection, uint32_t tableId, const Array<uint64_t>& rangeIds, uint64_t rangeSize, Map<uint64_t, uint64_t>& hashes);
+  static void_t printTransfer(const char_t* verb, uint64_t count, uint64_t bytes, const String& details, int64_t startTime);
+  bool_t isCompressed(uint32_t tableId);
+  void_t writeEntity(const zlimdb_entity& entity);
+  void_t showCompression();
+  bool_t loadTables();
+  bool_t findTableId(const String& name, uint32_t& tableId);
+  bool_t resolveTable(const String& table, uint32_t& tableId);
+  void_t writeTable(const zlimdb_table_entity& table, bool_t userNames);
+  void_t startMirror(uint32_t tableId, const String& dir);
+  bool_t subscribeMirror(Mirror& mirror);
+  void_t stopMirrors();
+  void_t startReplication(Replicator* replicator);
+  void_t deleteReplications(bool_t all);
+  void_t startSubscription(Subscription* subscription);
+  bool_t subscribeTable(Subscription& subscription);
+  void_t deleteSubscription(Subscription* subscription);
+  void_t stopSubscriptions();
+  static void_t printUpdate(void_t* userData, const Subscription::Update& update);
+  void_t startTop(Top* top);
+  bool_t subscribeTop();
+  void_t stopTop(bool_t unsubscribe);
 
 private:
   String error;
+  String userName;
+  String password;
+  String address;
+  Connection connection;
   zlimdb* zdb;
+  Mutex connectionMutex;
+  Signal reconnectSignal;
   volatile bool keepRunning;
   Thread thread;
-  Mutex actionMutex;
-  List<Action> actions;
+  LockFreeQueue<Action> actions;
+  ActionStrings* actionStrings;
+  LockFreeQueue<ActionStrings*> freeActionStrings; // for actions handled by the worker
+  LockFreeQueue<ActionStrings*> freeRequestStrings; // for requests handled by the lanes
+  volatile int32_t interruptPending;
   uint32_t selectedTable;
+  Array<Lane*> lanes;
+  LockFreeQueue<Action> requests; // table agnostic requests, taken by whichever lane is idle
+  Buffer requestBuffer; // for requests handled by the worker when there are no lanes
+  volatile uint32_t nextRequestId;
+  Mutex requestMutex;
+  HashSet<uint32_t> pendingRequests;
+  HashMap<uint32_t, uint_t> pendingTables; // number of pending requests per table
+  Signal requestSignal;
+  HashMap<uint32_t, Mirror*> mirrors;
+  List<Replicator*> replicators;
+  HashMap<uint32_t, Subscription*> subscriptions;
+  List<Merge*> merges;
+  Top* activeTop;
+  Ping* activePing;
+  Signal* pingDrained; // a drain waiting for the samples of the ping
+  TimeIndex timeIndex;
+  TableCache tableCache;
+  Stats stats;
+  Stats::Block* workerStats;
+  Stats::Counters* currentCounters;
+  int64_t actionStart;
+  bool_t responded;
+  String statsDumpFile;
+  int64_t statsDumpInterval;
+  int64_t nextStatsDump;
+  OutputWriter output;
+  Mutex compressionMutex;
+  HashSet<uint32_t> compressedTables;
+  PayloadCodec codec;
 
 private:
-  static String getZlimdbError();
+  static const String noString;
+
+  static const char_t* getActionName(ActionType type);
+  static uint32_t getRequestTable(ActionType type, uint64_t param1) {return type == createTableAction || type == findTableAction ? 0 : (uint32_t)param1;}
 };
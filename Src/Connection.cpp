@@ -0,0 +1,51 @@
+
+#include <nstd/Error.h>
+
+#include <zlimdbclient.h>
+
+#include "Connection.h"
+
+bool_t Connection::open(const String& userName, const String& password, const String& address, void_t (*callback)(void_t*, const void_t*), void_t* userData)
+{
+  close();
+
+  zdb = zlimdb_create((void (*)(void*, const zlimdb_header*))(callback ? callback : ignoreCallback), userData);
+  if(!zdb)
+    return error = getZlimdbError(), false;
+  uint16_t port = 0;
+  String host = address;
+  const char_t* colon = address.find(':');
+  if(colon)
+  {
+    port = String::toUInt(colon + 1);
+    host = address.substr(0, colon - (const char_t*)address);
+  }
+  if(zlimdb_connect(zdb, host, port, userName, password) != 0)
+  {
+    error = getZlimdbError();
+    close();
+    return false;
+  }
+  return true;
+}
+
+void_t Connection::close()
+{
+  if(zdb)
+  {
+    zlimdb_free(zdb);
+    zdb = 0;
+  }
+}
+
+String Connection::getZlimdbError()
+{
+  int err = zlimdb_errno();
+  if(err == zlimdb_local_error_system)
+    return Error::getErrorString();
+  else
+  {
+    const char* errstr = zlimdb_strerror(err);
+    return String(errstr, String::length(errstr));
+  }
+}
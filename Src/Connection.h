@@ -0,0 +1,32 @@
+
+#pragma once
+
+#include <nstd/String.h>
+
+typedef struct _zlimdb_ zlimdb;
+
+class Connection
+{
+public:
+  Connection() : zdb(0) {}
+  ~Connection() {close();}
+
+  String getLastError() const {return error;}
+
+  bool_t open(const String& userName, const String& password, const String& address, void_t (*callback)(void_t*, const void_t*) = 0, void_t* userData = 0);
+
+  void_t close();
+
+  bool_t isOpen() const {return zdb != 0;}
+
+  operator zlimdb*() const {return zdb;}
+
+  static String getZlimdbError();
+
+private:
+  String error;
+  zlimdb* zdb;
+
+private:
+  static void_t ignoreCallback(void_t* userData, const void_t* data) {}
+};
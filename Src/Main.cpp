@@ -1,9 +1,15 @@
 
 #include <nstd/Console.h>
 #include <nstd/Process.h>
+#include <nstd/Buffer.h>
+#include <nstd/Memory.h>
+#include <nstd/File.h>
+#include <nstd/Error.h>
 
 #include "Tools/Word.h"
+#include "Tools/CommandTable.h"
 
+#include "Benchmark.h"
 #include "Client.h"
 
 void_t help()
@@ -17,23 +23,584 @@ void_t help()
   Console::printf("clear - Clear selected table.\n");
   Console::printf("copy <name> - Create copy of selected table.\n");
   Console::printf("query [<id>] - Query data from selected table.\n");
-  Console::printf("select <num> - Select a table for further requests.\n");
+  Console::printf("query [--from <time>] [--to <time>] - Query data in a time range from selected table.\n");
+  Console::printf("agg --window <sec> [--from <time>] [--to <time>] - Show entity count, sizes and ids per time bucket of selected table.\n");
+  Console::printf("pquery [--connections <num>] [--export <file>] - Query selected table over several connections in id order, or unordered into an exported file.\n");
+  Console::printf("head <n> - Query the first <n> entities of selected table.\n");
+  Console::printf("tail <n> - Query the last <n> entities of selected table.\n");
+  Console::printf("select <num>|<name> - Select a table for further requests.\n");
   //Console::printf("add <value> - Add string data to selected table.\n");
   //Console::printf("addData <len> - Add <len> bytes to selected table.\n");
-  Console::printf("subscribe - Subscribe to selected table.\n");
+  Console::printf("subscribe [<num> ...] [--drop] - Subscribe to selected table or to several tables, dropping updates if output falls behind.\n");
+  Console::printf("subscribe --merge <num> <num> ... [--window <ms>] [--drop] - Subscribe to several tables and print their entities ordered by time.\n");
+  Console::printf("unsubscribe [<num>] - Stop a subscription.\n");
+  Console::printf("subscriptions - Show subscriptions with their update, drop and lag counters.\n");
+  Console::printf("top [<num> ...] - Show entity rates, sizes and lag of the given or all tables, refreshed every second.\n");
+  Console::printf("top stop - Stop showing table activity.\n");
   Console::printf("sync - Get time synchronization data of the selected table.\n");
+  Console::printf("ping [<count>] [<ms>] - Send repeated sync requests and show round trip times and the clock offset to the server, the samples are taken in the background.\n");
+  Console::printf("import <file> [lines|sized] [<num>] - Add records from a file to selected table using <num> connections.\n");
+  Console::printf("shard import <name> <num> <file> [lines|sized] [--key] - Add records from a file to <num> tables <name>/shard-<k>, routed round-robin or by the hash of their leading key field.\n");
+  Console::printf("shard query <name> <num> - Query <num> sharded tables and merge them by time.\n");
+  Console::printf("export <file> [<id>] - Write data from selected table to a compressed file.\n");
+  Console::printf("restore <file> [<num>] - Add data from an exported file to selected table using <num> connections.\n");
+  Console::printf("mirror <num> <dir> - Keep a memory mapped copy of a table in <dir>.\n");
+  Console::printf("replicate <addr> <table> <addr> <table> [--follow] [--connections <num>] - Copy a table to another server and optionally keep following it, more than one connection does not preserve the order.\n");
+  Console::printf("replicate stop - Stop all replications.\n");
+  Console::printf("checksum [<num>|<name>] - Compute range hashes of selected or given table.\n");
+  Console::printf("diff <num>|<name> <num>|<name> - Compare two tables and show the ids that differ.\n");
+  Console::printf("stats [reset|dump <file> <sec>|dump off] - Show or dump timing counters of each action.\n");
+  Console::printf("compress [on|off] - Compress payloads added to and decompress payloads read from selected table, or show compression counters.\n");
+  Console::printf("format text|csv|json|raw - Select the output format of queried entities and tables.\n");
+  Console::printf("bench %s - Measure throughput and latency.\n", Benchmark::getUsage());
   Console::printf("exit - Quit the session.\n");
 }
 
+typedef void_t (*Command)(Client& client, const Word* args, size_t count);
+
+enum
+{
+  maxWords = 256,
+  scriptBufferSize = 1024 * 1024,
+};
+
+void_t listUsers(Client& client, const Word* args, size_t count)
+{
+  client.listUsers();
+}
+
+void_t addUser(Client& client, const Word* args, size_t count)
+{
+  if(count < 3)
+    Console::errorf("error: Missing arguments: addUser <name> <pw>\n");
+  else
+    client.addUser(args[1].toString(), args[2].toString());
+}
+
+void_t listTables(Client& client, const Word* args, size_t count)
+{
+  client.listTables();
+}
+
+void_t createTable(Client& client, const Word* args, size_t count)
+{
+  if(count < 2)
+    Console::errorf("error: Missing argument: create <name>\n");
+  else
+    client.createTable(args[1].toString());
+}
+
+void_t removeTable(Client& client, const Word* args, size_t count)
+{
+  client.removeTable();
+}
+
+void_t clearTable(Client& client, const Word* args, size_t count)
+{
+  client.clearTable();
+}
+
+void_t copyTable(Client& client, const Word* args, size_t count)
+{
+  if(count < 2)
+    Console::errorf("error: Missing argument: copy <name>\n");
+  else
+    client.copyTable(args[1].toString());
+}
+
+void_t findTable(Client& client, const Word* args, size_t count)
+{
+  if(count < 2)
+    Console::errorf("error: Missing argument: find <name>\n");
+  else
+    client.findTable(args[1].toString());
+}
+
+void_t selectTable(Client& client, const Word* args, size_t count)
+{
+  if(count < 2)
+    Console::errorf("error: Missing argument: select <num>|<name>\n");
+  else if(String::isDigit(*args[1].data))
+    client.selectTable(args[1].toUInt());
+  else
+    client.selectTable(args[1].toString());
+}
+
+void_t query(Client& client, const Word* args, size_t count)
+{
+  if(count >= 3 && (args[1] == "--from" || args[1] == "--to"))
+  {
+    int64_t from = 0;
+    int64_t to = 0x7fffffffffffffffLL;
+    bool_t valid = true;
+    for(size_t i = 1; i < count; i += 2)
+    {
+      if(i + 1 == count)
+        valid = false;
+      else if(args[i] == "--from")
+        from = args[i + 1].toInt64();
+      else if(args[i] == "--to")
+        to = args[i + 1].toInt64();
+      else
+        valid = false;
+      if(!valid)
+        break;
+    }
+    if(!valid)
+      Console::errorf("error: Invalid arguments: query --from <time> --to <time>\n");
+    else
+      client.query(from, to);
+  }
+  else if(count >= 2)
+    client.query(args[1].toUInt64());
+  else
+    client.query();
+}
+
+void_t aggregate(Client& client, const Word* args, size_t count)
+{
+  int64_t window = 0;
+  int64_t from = 0;
+  int64_t to = 0x7fffffffffffffffLL;
+  bool_t valid = true;
+  for(size_t i = 1; i < count; i += 2)
+  {
+    if(i + 1 == count)
+      valid = false;
+    else if(args[i] == "--window")
+      window = args[i + 1].toInt64() * 1000;
+    else if(args[i] == "--from")
+      from = args[i + 1].toInt64();
+    else if(args[i] == "--to")
+      to = args[i + 1].toInt64();
+    else
+      valid = false;
+    if(!valid)
+      break;
+  }
+  if(!valid || window <= 0)
+    Console::errorf("error: Invalid arguments: agg --window <sec> [--from <time>] [--to <time>]\n");
+  else
+    client.aggregate(window, from, to);
+}
+
+void_t parallelQuery(Client& client, const Word* args, size_t count)
+{
+  uint_t connections = 8;
+  String file;
+  bool_t valid = true;
+  for(size_t i = 1; i < count; i += 2)
+  {
+    if(i + 1 == count)
+      valid = false;
+    else if(args[i] == "--connections")
+      connections = args[i + 1].toUInt();
+    else if(args[i] == "--export")
+      file = args[i + 1].toString();
+    else
+      valid = false;
+    if(!valid)
+      break;
+  }
+  if(!valid || connections == 0)
+    Console::errorf("error: Invalid arguments: pquery [--connections <num>] [--export <file>]\n");
+  else
+    client.parallelQuery(connections, file);
+}
+
+void_t headOrTail(Client& client, const Word* args, size_t count)
+{
+  bool_t head = args[0] == "head";
+  if(count < 2)
+    Console::errorf("error: Missing argument: %s <n>\n", head ? "head" : "tail");
+  else if(head)
+    client.head(args[1].toUInt64());
+  else
+    client.tail(args[1].toUInt64());
+}
+
+void_t subscribe(Client& client, const Word* args, size_t count)
+{
+  bool_t drop = false;
+  bool_t merge = false;
+  bool_t valid = true;
+  int64_t window = 1000;
+  Array<uint32_t> tableIds;
+  for(size_t i = 1; i < count; ++i)
+    if(args[i] == "--drop")
+      drop = true;
+    else if(args[i] == "--merge")
+      merge = true;
+    else if(args[i] == "--window")
+    {
+      if(++i == count)
+      {
+        valid = false;
+        break;
+      }
+      window = args[i].toInt64();
+    }
+    else
+      tableIds.append(args[i].toUInt());
+  if(!valid || (merge && tableIds.size() < 2))
+    Console::errorf("error: Invalid arguments: subscribe --merge <num> <num> ... [--window <ms>] [--drop]\n");
+  else if(merge)
+    client.subscribe(tableIds, window, drop);
+  else if(tableIds.isEmpty())
+    client.subscribe(drop);
+  else
+    for(size_t i = 0; i < tableIds.size(); ++i)
+      client.subscribe(tableIds[i], drop);
+}
+
+void_t unsubscribe(Client& client, const Word* args, size_t count)
+{
+  if(count < 2)
+    client.unsubscribe();
+  else
+    client.unsubscribe(args[1].toUInt());
+}
+
+void_t listSubscriptions(Client& client, const Word* args, size_t count)
+{
+  client.listSubscriptions();
+}
+
+void_t top(Client& client, const Word* args, size_t count)
+{
+  if(count == 2 && args[1] == "stop")
+    return client.stopTop();
+  Array<uint32_t> tableIds;
+  for(size_t i = 1; i < count; ++i)
+    tableIds.append(args[i].toUInt());
+  client.top(tableIds);
+}
+
+void_t sync(Client& client, const Word* args, size_t count)
+{
+  client.sync();
+}
+
+void_t ping(Client& client, const Word* args, size_t count)
+{
+  uint_t probes = count >= 2 ? args[1].toUInt() : 10;
+  uint_t interval = count >= 3 ? args[2].toUInt() : 200;
+  client.ping(probes ? probes : 1, interval);
+}
+
+void_t import(Client& client, const Word* args, size_t count)
+{
+  if(count < 2)
+    Console::errorf("error: Missing argument: import <file> [lines|sized] [<num>]\n");
+  else
+  {
+    bool_t sized = false;
+    uint_t connections = 16;
+    if(count >= 3)
+    {
+      if(args[2] == "sized")
+        sized = true;
+      else if(args[2] != "lines")
+        connections = 0;
+      if(connections && count >= 4)
+        connections = args[3].toUInt();
+    }
+    if(connections == 0)
+      Console::errorf("error: Invalid arguments: import <file> [lines|sized] [<num>]\n");
+    else
+      client.import(args[1].toString(), sized, connections);
+  }
+}
+
+void_t shard(Client& client, const Word* args, size_t count)
+{
+  if(count >= 4 && args[1] == "query")
+  {
+    uint_t shards = args[3].toUInt();
+    if(shards)
+      return client.queryShards(args[2].toString(), shards);
+  }
+  else if(count >= 5 && args[1] == "import")
+  {
+    uint_t shards = args[3].toUInt();
+    bool_t sized = false;
+    bool_t keyRouting = false;
+    bool_t valid = shards != 0;
+    for(size_t i = 5; i < count; ++i)
+      if(args[i] == "sized")
+        sized = true;
+      else if(args[i] == "--key")
+        keyRouting = true;
+      else if(args[i] != "lines")
+        valid = false;
+    if(valid)
+      return client.importShards(args[4].toString(), sized, args[2].toString(), shards, keyRouting);
+  }
+  Console::errorf("error: Invalid arguments: shard import <name> <num> <file> [lines|sized] [--key] | shard query <name> <num>\n");
+}
+
+void_t exportTable(Client& client, const Word* args, size_t count)
+{
+  if(count < 2)
+    Console::errorf("error: Missing argument: export <file> [<id>]\n");
+  else if(count >= 3)
+    client.exportTable(args[1].toString(), args[2].toUInt64());
+  else
+    client.exportTable(args[1].toString());
+}
+
+void_t restore(Client& client, const Word* args, size_t count)
+{
+  if(count < 2)
+    Console::errorf("error: Missing argument: restore <file> [<num>]\n");
+  else
+  {
+    uint_t connections = count < 3 ? 16 : args[2].toUInt();
+    client.restore(args[1].toString(), connections ? connections : 1);
+  }
+}
+
+void_t mirror(Client& client, const Word* args, size_t count)
+{
+  if(count < 3)
+    Console::errorf("error: Missing arguments: mirror <num> <dir>\n");
+  else
+    client.mirror(args[1].toUInt(), args[2].toString());
+}
+
+void_t replicate(Client& client, const Word* args, size_t count)
+{
+  const Word* positional[4];
+  size_t positionalCount = 0;
+  bool_t follow = false;
+  uint_t connections = 1;
+  bool_t valid = true;
+  for(size_t i = 1; i < count; ++i)
+    if(args[i] == "--follow")
+      follow = true;
+    else if(args[i] == "--connections")
+    {
+      if(++i == count)
+      {
+        valid = false;
+        break;
+      }
+      connections = args[i].toUInt();
+    }
+    else if(args[i].startsWith("--") || positionalCount == 4)
+      valid = false;
+    else
+      positional[positionalCount++] = &args[i];
+  if(valid && positionalCount == 1 && *positional[0] == "stop")
+    client.stopReplications();
+  else if(!valid || positionalCount != 4)
+    Console::errorf("error: Invalid arguments: replicate <addr> <table> <addr> <table> [--follow] [--connections <num>]\n");
+  else
+    client.replicate(positional[0]->toString(), positional[1]->toString(), positional[2]->toString(), positional[3]->toString(), follow, connections ? connections : 1);
+}
+
+void_t checksum(Client& client, const Word* args, size_t count)
+{
+  client.checksum(count >= 2 ? args[1].toString() : String());
+}
+
+void_t diff(Client& client, const Word* args, size_t count)
+{
+  if(count < 3)
+    Console::errorf("error: Missing arguments: diff <num>|<name> <num>|<name>\n");
+  else
+    client.diff(args[1].toString(), args[2].toString());
+}
+
+void_t stats(Client& client, const Word* args, size_t count)
+{
+  if(count < 2)
+    client.printStats();
+  else if(args[1] == "reset")
+    client.resetStats();
+  else if(args[1] == "dump" && count >= 3 && args[2] == "off")
+    client.dumpStats(String(), 0);
+  else if(args[1] == "dump" && count >= 4)
+  {
+    uint_t interval = args[3].toUInt();
+    client.dumpStats(args[2].toString(), interval ? interval : 1);
+  }
+  else
+    Console::errorf("error: Invalid arguments: stats [reset|dump <file> <sec>|dump off]\n");
+}
+
+void_t compress(Client& client, const Word* args, size_t count)
+{
+  if(count < 2)
+    client.printCompression();
+  else if(args[1] == "on" || args[1] == "off")
+    client.compress(args[1] == "on");
+  else
+    Console::errorf("error: Invalid argument: compress [on|off]\n");
+}
+
+void_t setFormat(Client& client, const Word* args, size_t count)
+{
+  OutputWriter::Format format;
+  if(count < 2)
+    Console::errorf("error: Missing argument: format text|csv|json|raw\n");
+  else if(!OutputWriter::parseFormat(args[1].toString(), format))
+    Console::errorf("error: Unknown format: %s\n", (const char_t*)args[1].toString());
+  else
+    client.setFormat(format);
+}
+
+void_t bench(Client& client, const Word* args, size_t count)
+{
+  String spec;
+  for(size_t i = 1; i < count; ++i)
+  {
+    if(!spec.isEmpty())
+      spec += ' ';
+    spec.append(args[i].data, args[i].length);
+  }
+  client.bench(spec);
+}
+
+void_t showHelp(Client& client, const Word* args, size_t count)
+{
+  help();
+}
+
+void_t initCommands(CommandTable<Command>& commands)
+{
+  commands.add("help", showHelp);
+  commands.add("listUsers", listUsers);
+  commands.add("addUser", addUser);
+  commands.add("list", listTables);
+  commands.add("create", createTable);
+  commands.add("remove", removeTable);
+  commands.add("clear", clearTable);
+  commands.add("copy", copyTable);
+  commands.add("find", findTable);
+  commands.add("select", selectTable);
+  commands.add("query", query);
+  commands.add("agg", aggregate);
+  commands.add("pquery", parallelQuery);
+  commands.add("head", headOrTail);
+  commands.add("tail", headOrTail);
+  commands.add("subscribe", subscribe);
+  commands.add("unsubscribe", unsubscribe);
+  commands.add("subscriptions", listSubscriptions);
+  commands.add("top", top);
+  commands.add("sync", sync);
+  commands.add("ping", ping);
+  commands.add("import", import);
+  commands.add("export", exportTable);
+  commands.add("shard", shard);
+  commands.add("restore", restore);
+  commands.add("mirror", mirror);
+  commands.add("replicate", replicate);
+  commands.add("checksum", checksum);
+  commands.add("diff", diff);
+  commands.add("stats", stats);
+  commands.add("compress", compress);
+  commands.add("format", setFormat);
+  commands.add("bench", bench);
+}
+
+bool_t execute(Client& client, const CommandTable<Command>& commands, const char_t* line)
+{
+  Word args[maxWords];
+  size_t count = Word::split(line, args, maxWords);
+  if(!count)
+    return true;
+  if(count > maxWords)
+    return Console::errorf("error: Too many arguments\n"), true;
+  if(args[0] == "exit" || args[0] == "quit")
+    return false;
+  Command command;
+  if(!commands.find(args[0], command))
+    return Console::errorf("error: Unknown command: %s\n", (const char_t*)args[0].toString()), true;
+  command(client, args, count);
+  return true;
+}
+
+char_t* findLineEnd(char_t* pos, char_t* end)
+{
+  for(; pos < end; ++pos)
+    if(*pos == '\n')
+      return pos;
+  return 0;
+}
+
+bool_t runScript(Client& client, const CommandTable<Command>& commands, const String& file)
+{
+  // lines are terminated in place and tokenized without copying, only the unfinished tail of the buffer is moved
+  File fp;
+  // "-" reads the script from the standard input device
+#ifdef _WIN32
+  String fileName = file == "-" ? String("CONIN$") : file;
+#else
+  String fileName = file == "-" ? String("/dev/stdin") : file;
+#endif
+  if(!fp.open(fileName))
+    return Console::errorf("error: Could not open file %s: %s\n", (const char_t*)file, (const char_t*)Error::getErrorString()), false;
+  Buffer buffer(scriptBufferSize + 1);
+  buffer.resize(scriptBufferSize + 1);
+  char_t* data = (char_t*)(byte_t*)buffer;
+  size_t size = 0;
+  bool_t result = true;
+  for(bool_t keepRunning = true; keepRunning;)
+  {
+    ssize_t read = fp.read(data + size, scriptBufferSize - size);
+    if(read < 0)
+    {
+      Console::errorf("error: Could not read from file %s: %s\n", (const char_t*)file, (const char_t*)Error::getErrorString());
+      result = false;
+      break;
+    }
+    size += read;
+    bool_t eof = read == 0;
+    if(eof && size)
+      data[size++] = '\n';
+    char_t* pos = data;
+    char_t* end = data + size;
+    for(char_t* lineEnd; keepRunning && (lineEnd = findLineEnd(pos, end)); pos = lineEnd + 1)
+    {
+      *lineEnd = '\0';
+      if(lineEnd > pos && lineEnd[-1] == '\r')
+        lineEnd[-1] = '\0';
+      if(*pos != '#')
+        keepRunning = execute(client, commands, pos);
+    }
+    size = end - pos;
+    if(eof || !keepRunning)
+      break;
+    if(size == scriptBufferSize)
+    {
+      Console::errorf("error: Line exceeds %u bytes in file %s\n", (uint_t)scriptBufferSize, (const char_t*)file);
+      result = false;
+      break;
+    }
+    Memory::move(data, pos, size);
+  }
+  client.drain();
+  return result;
+}
+
 int_t main(int_t argc, char_t* argv[])
 {
   String password("root");
   String user("root");
   String address("127.0.0.1:13211");
+  String benchSpec;
+  String script;
+  uint_t workers = 0; // lanes are opt-in, requests are handled by the worker connection otherwise
+  OutputWriter::Format format = OutputWriter::textFormat;
   {
     Process::Option options[] = {
         {'p', "password", Process::argumentFlag},
         {'u', "user", Process::argumentFlag},
+        {'b', "bench", Process::argumentFlag},
+        {'f', "format", Process::argumentFlag},
+        {'s', "script", Process::argumentFlag},
+        {'w', "workers", Process::argumentFlag},
         {'h', "help", Process::optionFlag},
     };
     Process::Arguments arguments(argc, argv, options);
@@ -48,6 +615,22 @@ int_t main(int_t argc, char_t* argv[])
       case 'u':
         user = argument;
         break;
+      case 'b':
+        benchSpec = argument;
+        break;
+      case 'f':
+        if(!OutputWriter::parseFormat(argument, format))
+        {
+          Console::errorf("Unknown format: %s.\n", (const char_t*)argument);
+          return 1;
+        }
+        break;
+      case 's':
+        script = argument;
+        break;
+      case 'w':
+        workers = argument.toUInt();
+        break;
       case 0:
         address = argument;
         break;
@@ -58,136 +641,37 @@ int_t main(int_t argc, char_t* argv[])
         Console::errorf("Option %s required an argument.\n", (const char_t*)argument);
         return 1;
       default:
-        Console::errorf("Usage: %s [-u <user>] [-p <password>] [<address>]\n", argv[0]);
+        Console::errorf("Usage: %s [-u <user>] [-p <password>] [-f text|csv|json|raw] [--script <file>|-] [--workers <num>] [--bench \"%s\"] [<address>]\n", argv[0], Benchmark::getUsage());
         return 1;
       }
   }
-
-  Console::Prompt prompt;
   Client client;
-  if(!client.connect(user, password, address))
+  if(!client.connect(user, password, address, workers))
     return Console::errorf("error: Could not establish connection: %s\n", (const char_t*)client.getLastError()), 1;
+  if(format != OutputWriter::textFormat)
+    client.setFormat(format);
+  if(!benchSpec.isEmpty())
+  {
+    client.bench(benchSpec);
+    client.drain();
+    client.disconnect();
+    return 0;
+  }
+  CommandTable<Command> commands;
+  initCommands(commands);
+  if(!script.isEmpty())
+  {
+    bool_t result = runScript(client, commands, script);
+    client.disconnect();
+    return result ? 0 : 1;
+  }
+  Console::Prompt prompt;
   for(;;)
   {
     String result = prompt.getLine("zlimdb> ");
     Console::printf(String("zlimdb> ") + result + "\n");
-
-    List<String> args;
-    Word::split(result, args);
-    String cmd = args.isEmpty() ? String() : args.front();
-
-    if(cmd == "exit" || cmd == "quit")
+    if(!execute(client, commands, result))
       break;
-    else if(cmd == "help")
-      help();
-    else if(cmd == "listUsers")
-      client.listUsers();
-    else if(cmd == "addUser")
-    {
-      if(args.size() < 3)
-        Console::errorf("error: Missing arguments: addUser <name> <pw>\n");
-      else
-      {
-        String name = *(++args.begin());
-        String password = *(++(++args.begin()));
-        client.addUser(name, password);
-      }
-    }
-    else if(cmd == "list")
-      client.listTables();
-    else if(cmd == "create")
-    {
-      if(args.size() < 2)
-        Console::errorf("error: Missing argument: create <name>\n");
-      else
-      {
-        String name = *(++args.begin());
-        client.createTable(name);
-      }
-    }
-    else if(cmd == "remove")
-    {
-      client.removeTable();
-    }
-    else if(cmd == "clear")
-    {
-      client.clearTable();
-    }
-    else if(cmd == "copy")
-    {
-      if(args.size() < 2)
-        Console::errorf("error: Missing argument: copy <name>\n");
-      else
-      {
-        String name = *(++args.begin());
-        client.copyTable(name);
-      }
-    }
-    else if(cmd == "find")
-    {
-      if(args.size() < 2)
-        Console::errorf("error: Missing argument: find <name>\n");
-      else
-      {
-        String name = *(++args.begin());
-        client.findTable(name);
-      }
-    }
-    else if(cmd == "select")
-    {
-      if(args.size() < 2)
-        Console::errorf("error: Missing argument: select <num>\n");
-      else
-      {
-        String num = *(++args.begin());
-        client.selectTable(num.toUInt());
-      }
-    }
-    else if(cmd == "query")
-    {
-      if(args.size() >= 2)
-      {
-        uint64_t id = (++args.begin())->toUInt64();
-        client.query(id);
-      }
-      else
-        client.query();
-    }
-    //else if(cmd == "add")
-    //{
-    //  if(args.size() < 2)
-    //    Console::errorf("error: Missing argument: add <value>\n");
-    //  else
-    //  {
-    //    String value = *(++args.begin());
-    //    client.add(value);
-    //  }
-    //}
-    //else if(cmd == "addData")
-    //{
-    //  if(args.size() < 2)
-    //    Console::errorf("error: Missing argument: addData <len>\n");
-    //  else
-    //  {
-    //    size_t len = (++args.begin())->toUInt();
-    //    size_t count = args.size() < 3 ? 1 : (++(++args.begin()))->toUInt();
-    //    String value;
-    //    value.resize(len);
-    //    Memory::fill((char_t*)value, 'a', len);
-    //    for(size_t i = 0; i < count; ++i)
-    //      client.add(value);
-    //  }
-    //}
-    else if(cmd == "subscribe")
-    {
-      client.subscribe();
-    }
-    else if(cmd == "sync")
-    {
-      client.sync();
-    }
-    else if(!cmd.isEmpty())
-      Console::errorf("error: Unknown command: %s\n", (const char_t*)cmd);
   }
   client.disconnect();
   return 0;
@@ -0,0 +1,64 @@
+
+#include "Merge.h"
+
+Merge::Merge(const Array<uint32_t>& tableIds, int64_t window) : openInputs((uint_t)tableIds.size()), window(window), merger((uint_t)tableIds.size(), window, writeEntity, this)
+{
+  inputs.resize(tableIds.size());
+  for(size_t i = 0; i < tableIds.size(); ++i)
+  {
+    Input& input = inputs[i];
+    input.merge = this;
+    input.index = (uint_t)i;
+    input.tableId = tableIds[i];
+  }
+}
+
+void_t Merge::advance(int64_t now)
+{
+  // release entities held back for the reorder window when the inputs went quiet
+  mutex.lock();
+  merger.advance(now);
+  writer.flush();
+  mutex.unlock();
+}
+
+void_t Merge::flush()
+{
+  mutex.lock();
+  merger.flush();
+  writer.flush();
+  mutex.unlock();
+}
+
+bool_t Merge::close(void_t* input)
+{
+  // an input without a subscription must not hold back the others, returns false once no input is left
+  mutex.lock();
+  merger.close(((Input*)input)->index);
+  writer.flush();
+  bool_t open = --openInputs != 0;
+  mutex.unlock();
+  return open;
+}
+
+void_t Merge::handleUpdate(void_t* userData, const Subscription::Update& update)
+{
+  Input* input = (Input*)userData;
+  Merge* merge = input->merge;
+  const zlimdb_entity* first = update.getFirstEntity();
+  if(!first)
+    return;
+  const zlimdb_entity* last = first;
+  for(const zlimdb_entity* entity = first; entity; entity = update.getNextEntity(entity))
+    last = entity;
+  merge->mutex.lock();
+  merge->merger.add(input->index, first, (const byte_t*)last + last->size - (const byte_t*)first);
+  if(!update.pending)
+    merge->writer.flush();
+  merge->mutex.unlock();
+}
+
+void_t Merge::writeEntity(void_t* userData, uint_t input, const zlimdb_entity& entity)
+{
+  ((Merge*)userData)->writer.writeEntity(entity);
+}
@@ -0,0 +1,53 @@
+
+#pragma once
+
+#include <nstd/Array.h>
+#include <nstd/Mutex.h>
+
+#include "Tools/TimeMerger.h"
+#include "Tools/OutputWriter.h"
+#include "Subscription.h"
+
+class Merge
+{
+public:
+  Merge(const Array<uint32_t>& tableIds, int64_t window);
+
+  void_t setFormat(OutputWriter::Format format) {writer.setFormat(format);}
+
+  uint_t getInputCount() const {return (uint_t)inputs.size();}
+  uint32_t getTableId(uint_t index) const {return inputs[index].tableId;}
+  void_t* getInput(uint_t index) {return &inputs[index];}
+  int64_t getWindow() const {return window;}
+
+  void_t advance(int64_t now);
+  void_t flush();
+
+  static Merge* getMerge(void_t* input) {return ((Input*)input)->merge;}
+  bool_t close(void_t* input);
+
+  uint64_t getEmittedCount() const {return merger.getEmittedCount();}
+  uint64_t getLateCount() const {return merger.getLateCount();}
+  size_t getBufferedBlockCount() const {return merger.getBufferedBlockCount();}
+
+  static void_t handleUpdate(void_t* userData, const Subscription::Update& update);
+
+private:
+  struct Input
+  {
+    Merge* merge;
+    uint_t index;
+    uint32_t tableId;
+  };
+
+private:
+  Array<Input> inputs;
+  uint_t openInputs;
+  int64_t window;
+  Mutex mutex;
+  TimeMerger merger;
+  OutputWriter writer;
+
+private:
+  static void_t writeEntity(void_t* userData, uint_t input, const zlimdb_entity& entity);
+};
@@ -0,0 +1,67 @@
+
+#include <nstd/Directory.h>
+#include <nstd/Error.h>
+#include <nstd/Memory.h>
+#include <nstd/Math.h>
+
+#include "Mirror.h"
+
+const char_t Mirror::fileMagic[] = "zlimdbm1";
+
+bool_t Mirror::open(const String& dir, uint32_t tableId)
+{
+  if(!Directory::exists(dir) && !Directory::create(dir))
+    return error = Error::getErrorString(), false;
+  fileName.printf("%s/table-%u.mirror", (const char_t*)dir, tableId);
+  if(!file.open(fileName))
+    return error = file.getLastError(), false;
+  if(file.getSize() < sizeof(Header))
+  {
+    if(!file.resize(sizeof(Header) + minGrowth))
+      return error = file.getLastError(), false;
+    header = (Header*)file.getData();
+    Memory::zero(header, sizeof(Header));
+    Memory::copy(header->magic, fileMagic, sizeof(header->magic));
+    header->tableId = tableId;
+    header->headerSize = sizeof(Header);
+    return true;
+  }
+  header = (Header*)file.getData();
+  if(Memory::compare(header->magic, fileMagic, sizeof(header->magic)) != 0 || header->headerSize != sizeof(Header) ||
+     header->dataSize > file.getSize() - sizeof(Header))
+    return error = "Unknown file format", header = 0, false;
+  if(header->tableId != tableId)
+    return error = "File belongs to another table", header = 0, false;
+  return true;
+}
+
+bool_t Mirror::append(const zlimdb_entity& entity)
+{
+  if(!header)
+    return false;
+  if(entity.id <= header->lastId)
+    return true; // already mirrored
+  uint64_t offset = sizeof(Header) + header->dataSize;
+  if(offset + entity.size > file.getSize())
+  {
+    // grow geometrically, so that remapping stays rare even for big tables
+    uint64_t growth = Math::max((uint64_t)minGrowth, Math::min((uint64_t)maxGrowth, file.getSize()));
+    if(!file.resize(file.getSize() + Math::max(growth, (uint64_t)entity.size)))
+      return error = file.getLastError(), header = 0, false;
+    header = (Header*)file.getData();
+  }
+  Memory::copy(file.getData() + offset, &entity, entity.size);
+  header->lastId = entity.id;
+  ++header->entityCount;
+  header->dataSize += entity.size;
+  return true;
+}
+
+bool_t Mirror::sync()
+{
+  if(!header)
+    return false;
+  if(!file.sync())
+    return error = file.getLastError(), false;
+  return true;
+}
@@ -0,0 +1,49 @@
+
+#pragma once
+
+#include <zlimdbprotocol.h>
+
+#include "Tools/MappedFile.h"
+
+class Mirror
+{
+public:
+  Mirror() : header(0) {}
+
+  String getLastError() const {return error;}
+
+  bool_t open(const String& dir, uint32_t tableId);
+
+  bool_t append(const zlimdb_entity& entity);
+  bool_t sync();
+
+  uint32_t getTableId() const {return header ? header->tableId : 0;}
+  uint64_t getLastId() const {return header ? header->lastId : 0;}
+  uint64_t getEntityCount() const {return header ? header->entityCount : 0;}
+  String getFileName() const {return fileName;}
+
+private:
+  enum
+  {
+    minGrowth = 1024 * 1024,
+    maxGrowth = 256 * 1024 * 1024,
+  };
+
+  static const char_t fileMagic[];
+
+  struct Header
+  {
+    char_t magic[8];
+    uint32_t tableId;
+    uint32_t headerSize;
+    uint64_t dataSize; // bytes of entity data following the header, updated after the entity was written
+    uint64_t lastId;
+    uint64_t entityCount;
+  };
+
+private:
+  String error;
+  String fileName;
+  MappedFile file;
+  Header* header;
+};
@@ -0,0 +1,224 @@
+
+#include <nstd/Error.h>
+
+#include <zlimdbclient.h>
+
+#include "ParallelQuery.h"
+
+ParallelQuery::ParallelQuery() : tableId(0), ordered(false), currentBlock(0), currentRange(0), keepRunning(false), blockCount(0) {}
+
+ParallelQuery::~ParallelQuery()
+{
+  stop();
+}
+
+bool_t ParallelQuery::start(const String& userName, const String& password, const String& address, uint32_t tableId, uint64_t lastId, uint_t connections, bool_t ordered)
+{
+  stop();
+  this->tableId = tableId;
+  this->ordered = ordered;
+  blockCount = 0;
+  if(connections == 0)
+    connections = 1;
+  uint64_t step = lastId / connections;
+  if(step == 0)
+    connections = 1;
+
+  // each range starts behind the first id of the previous one and stops at the start of the next one, the last range is open
+  // ended to include entities added during the scan
+  keepRunning = true;
+  for(uint_t i = 0; i < connections; ++i)
+  {
+    Range* range = new Range;
+    range->query = this;
+    range->sinceId = step * i;
+    range->endId = i + 1 < connections ? step * (i + 1) : 0xffffffffffffffffULL;
+    range->done = false;
+    ranges.append(range);
+    if(!range->connection.open(userName, password, address))
+    {
+      error = range->connection.getLastError();
+      stop();
+      return false;
+    }
+  }
+  for(Array<Range*>::Iterator i = ranges.begin(), end = ranges.end(); i != end; ++i)
+    if(!(*i)->thread.start(Range::threadProc, *i))
+    {
+      error = Error::getErrorString();
+      stop();
+      return false;
+    }
+  return true;
+}
+
+const zlimdb_header* ParallelQuery::read()
+{
+  mutex.lock();
+  if(currentBlock)
+  {
+    freeBlocks.append(currentBlock);
+    currentBlock = 0;
+  }
+  for(;;)
+  {
+    // take the next block of the oldest unfinished range when ordered, of any range otherwise
+    bool_t pending = false;
+    for(size_t i = ordered ? currentRange : 0; i < ranges.size(); ++i)
+    {
+      Range* range = ranges[i];
+      if(!range->error.isEmpty())
+      {
+        error = range->error;
+        mutex.unlock();
+        return 0;
+      }
+      if(!range->blocks.isEmpty())
+      {
+        currentBlock = range->blocks.front();
+        range->blocks.removeFront();
+        range->space.set();
+        mutex.unlock();
+        ++blockCount;
+        return (const zlimdb_header*)(const byte_t*)*currentBlock;
+      }
+      if(!range->done)
+      {
+        pending = true;
+        if(ordered)
+          break;
+      }
+      else if(ordered && i == currentRange)
+        ++currentRange;
+    }
+    if(!pending)
+    {
+      mutex.unlock();
+      return 0;
+    }
+    changed.reset();
+    mutex.unlock();
+    changed.wait();
+    mutex.lock();
+  }
+}
+
+uint_t ParallelQuery::Range::threadProc(void_t* param)
+{
+  Range* range = (Range*)param;
+  range->query->process(*range);
+  return 0;
+}
+
+void_t ParallelQuery::process(Range& range)
+{
+  String error;
+  if(zlimdb_query(range.connection, tableId, range.sinceId ? zlimdb_query_type_since_id : zlimdb_query_type_all, range.sinceId) != 0)
+    error = Connection::getZlimdbError();
+  else
+  {
+    bool_t passed = false;
+    Buffer* block = popFreeBlock();
+    while(keepRunning && zlimdb_get_response(range.connection, (zlimdb_header*)(byte_t*)*block, ZLIMDB_MAX_MESSAGE_SIZE) == 0)
+    {
+      // cut the block at the first entity that belongs to the next range
+      zlimdb_header* header = (zlimdb_header*)(byte_t*)*block;
+      const zlimdb_entity* first = zlimdb_get_first_entity(header, sizeof(zlimdb_entity));
+      for(const zlimdb_entity* entity = first; entity; entity = zlimdb_get_next_entity(header, sizeof(zlimdb_entity), entity))
+        if(entity->id > range.endId)
+        {
+          header->size = (const byte_t*)entity - (const byte_t*)header;
+          passed = true;
+          break;
+        }
+      if(first && (const byte_t*)first < (const byte_t*)header + header->size)
+      {
+        if(!push(range, block))
+          break;
+        block = popFreeBlock();
+      }
+      if(passed)
+        break;
+    }
+    if(!passed && keepRunning && zlimdb_errno() != zlimdb_local_error_none)
+      error = Connection::getZlimdbError();
+    mutex.lock();
+    freeBlocks.append(block);
+    mutex.unlock();
+  }
+
+  // a range that passed its end is aborted by dropping its connection
+  mutex.lock();
+  range.connection.close();
+  range.error = error;
+  range.done = true;
+  changed.set();
+  mutex.unlock();
+}
+
+Buffer* ParallelQuery::popFreeBlock()
+{
+  Buffer* block;
+  mutex.lock();
+  if(freeBlocks.isEmpty())
+    block = new Buffer(ZLIMDB_MAX_MESSAGE_SIZE);
+  else
+  {
+    block = freeBlocks.front();
+    freeBlocks.removeFront();
+  }
+  mutex.unlock();
+  block->resize(ZLIMDB_MAX_MESSAGE_SIZE);
+  return block;
+}
+
+bool_t ParallelQuery::push(Range& range, Buffer* block)
+{
+  mutex.lock();
+  while(keepRunning && range.blocks.size() >= maxQueuedBlocks)
+  {
+    range.space.reset();
+    mutex.unlock();
+    range.space.wait();
+    mutex.lock();
+  }
+  if(!keepRunning)
+  {
+    freeBlocks.append(block);
+    mutex.unlock();
+    return false;
+  }
+  range.blocks.append(block);
+  changed.set();
+  mutex.unlock();
+  return true;
+}
+
+void_t ParallelQuery::stop()
+{
+  mutex.lock();
+  keepRunning = false;
+  for(Array<Range*>::Iterator i = ranges.begin(), end = ranges.end(); i != end; ++i)
+  {
+    Range* range = *i;
+    if(!range->done && range->connection.isOpen())
+      zlimdb_interrupt(range->connection);
+    range->space.set();
+  }
+  mutex.unlock();
+  for(Array<Range*>::Iterator i = ranges.begin(), end = ranges.end(); i != end; ++i)
+  {
+    Range* range = *i;
+    range->thread.join();
+    for(List<Buffer*>::Iterator j = range->blocks.begin(), end = range->blocks.end(); j != end; ++j)
+      delete *j;
+    delete range;
+  }
+  ranges.clear();
+  for(List<Buffer*>::Iterator i = freeBlocks.begin(), end = freeBlocks.end(); i != end; ++i)
+    delete *i;
+  freeBlocks.clear();
+  delete currentBlock;
+  currentBlock = 0;
+  currentRange = 0;
+}
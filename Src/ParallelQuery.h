@@ -0,0 +1,70 @@
+
+#pragma once
+
+#include <nstd/Thread.h>
+#include <nstd/Mutex.h>
+#include <nstd/Signal.h>
+#include <nstd/List.h>
+#include <nstd/Array.h>
+#include <nstd/Buffer.h>
+
+#include <zlimdbprotocol.h>
+
+#include "Connection.h"
+
+class ParallelQuery
+{
+public:
+  ParallelQuery();
+  ~ParallelQuery();
+
+  String getLastError() const {return error;}
+
+  bool_t start(const String& userName, const String& password, const String& address, uint32_t tableId, uint64_t lastId, uint_t connections, bool_t ordered);
+
+  const zlimdb_header* read();
+
+  uint64_t getBlockCount() const {return blockCount;}
+
+private:
+  class Range
+  {
+  public:
+    ParallelQuery* query;
+    Connection connection;
+    Thread thread;
+    uint64_t sinceId;
+    uint64_t endId;
+    List<Buffer*> blocks;
+    Signal space;
+    bool_t done;
+    String error;
+
+  public:
+    static uint_t threadProc(void_t* param);
+  };
+
+  enum
+  {
+    maxQueuedBlocks = 256,
+  };
+
+private:
+  String error;
+  uint32_t tableId;
+  bool_t ordered;
+  Array<Range*> ranges;
+  Mutex mutex;
+  Signal changed;
+  List<Buffer*> freeBlocks;
+  Buffer* currentBlock;
+  size_t currentRange;
+  volatile bool_t keepRunning;
+  uint64_t blockCount;
+
+private:
+  void_t process(Range& range);
+  Buffer* popFreeBlock();
+  bool_t push(Range& range, Buffer* block);
+  void_t stop();
+};
@@ -0,0 +1,47 @@
+
+#include <nstd/Console.h>
+
+#include "Ping.h"
+
+void_t Ping::add(int64_t localTime, int64_t roundTripTime, int64_t serverTime, int64_t tableTime, int64_t now)
+{
+  // both clocks are read in milliseconds, so the offset is never finer than that
+  Sample sample;
+  sample.roundTripTime = roundTripTime;
+  sample.offset = serverTime - (localTime + (roundTripTime + 1000) / 2000);
+  tableOffset = serverTime - tableTime;
+  histogram.add(roundTripTime);
+  Console::printf("sync %u: rtt=%.3f ms, offset=%lld ms, tableOffset=%lld ms\n", (uint_t)samples.size() + 1, (double)roundTripTime / 1000.,
+    sample.offset, tableOffset);
+
+  size_t i = samples.size();
+  samples.append(sample);
+  for(; i > 0 && samples[i - 1].roundTripTime > sample.roundTripTime; --i)
+    samples[i] = samples[i - 1];
+  samples[i] = sample;
+  nextSample = now + interval;
+}
+
+void_t Ping::printSummary() const
+{
+  if(samples.isEmpty())
+    return;
+
+  // the fastest probes waited least in queues on either side, so their offsets are the most accurate
+  size_t best = samples.size() / 4;
+  if(best < 3)
+    best = samples.size() < 3 ? samples.size() : 3;
+  int64_t offsetSum = 0, minOffset = samples[0].offset, maxOffset = samples[0].offset;
+  for(size_t i = 0; i < best; ++i)
+  {
+    int64_t offset = samples[i].offset;
+    offsetSum += offset;
+    if(offset < minOffset)
+      minOffset = offset;
+    if(offset > maxOffset)
+      maxOffset = offset;
+  }
+  Console::printf("ping: %u probes, rtt min/avg/p99=%.3f/%.3f/%.3f ms, offset=%.1f ms, spread=%lld ms (%u fastest probes, 1 ms clock resolution), tableOffset=%lld ms\n",
+    (uint_t)samples.size(), (double)histogram.getMin() / 1000., histogram.getMean() / 1000., (double)histogram.getPercentile(99.) / 1000.,
+    (double)offsetSum / (double)best, maxOffset - minOffset, (uint_t)best, tableOffset);
+}
@@ -0,0 +1,35 @@
+
+#pragma once
+
+#include <nstd/Array.h>
+
+#include "Tools/Histogram.h"
+
+class Ping
+{
+public:
+  Ping(uint32_t tableId, uint_t count, uint_t interval) : tableId(tableId), count(count), interval(interval), nextSample(0), tableOffset(0) {}
+
+  uint32_t getTableId() const {return tableId;}
+  int64_t getNextSample() const {return nextSample;}
+  bool_t isDone() const {return samples.size() >= count;}
+
+  void_t add(int64_t localTime, int64_t roundTripTime, int64_t serverTime, int64_t tableTime, int64_t now);
+  void_t printSummary() const;
+
+private:
+  struct Sample
+  {
+    int64_t roundTripTime; // microseconds
+    int64_t offset; // milliseconds the server clock is ahead of the local clock at the middle of the round trip
+  };
+
+private:
+  uint32_t tableId;
+  uint_t count;
+  uint_t interval;
+  int64_t nextSample;
+  int64_t tableOffset;
+  Histogram histogram;
+  Array<Sample> samples; // ordered by round trip time
+};
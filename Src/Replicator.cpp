@@ -0,0 +1,174 @@
+
+#include <nstd/Console.h>
+#include <nstd/Error.h>
+#include <nstd/Time.h>
+
+#include <zlimdbclient.h>
+
+#include "Replicator.h"
+
+Replicator::Replicator(const String& sourceAddress, const String& sourceTable, const String& destinationAddress, const String& destinationTable,
+  bool_t follow, uint_t connections) :
+  sourceAddress(sourceAddress), sourceTable(sourceTable), destinationAddress(destinationAddress), destinationTable(destinationTable),
+  follow(follow), connections(connections), sourceTableId(0), destinationTableId(0), keepRunning(false), running(false), lastEntityTime(0) {}
+
+Replicator::~Replicator()
+{
+  stop();
+}
+
+String Replicator::getName() const
+{
+  return sourceAddress + "/" + sourceTable + " -> " + destinationAddress + "/" + destinationTable;
+}
+
+bool_t Replicator::start(const String& userName, const String& password)
+{
+  // the destination table is looked up or created on a short lived connection, since the connections of the adder only send add requests
+  {
+    Connection control;
+    if(!control.open(userName, password, destinationAddress))
+      return error = control.getLastError(), false;
+    if(!resolveTable(control, destinationTable, true, destinationTableId))
+      return error = Connection::getZlimdbError(), false;
+  }
+  if(!source.open(userName, password, sourceAddress, zlimdbCallback, this))
+    return error = source.getLastError(), false;
+  if(!resolveTable(source, sourceTable, false, sourceTableId))
+    return error = Connection::getZlimdbError(), false;
+  if(!adder.start(userName, password, destinationAddress, destinationTableId, connections))
+    return error = adder.getLastError(), false;
+  keepRunning = true;
+  running = true;
+  if(!thread.start(threadProc, this))
+    return error = Error::getErrorString(), running = false, adder.finish(), false;
+  return true;
+}
+
+void_t Replicator::stop()
+{
+  keepRunning = false;
+  if(source.isOpen())
+    zlimdb_interrupt(source);
+  if(running)
+    adder.abort(); // the thread may be waiting for a hanging destination
+  thread.join();
+  source.close();
+}
+
+bool_t Replicator::resolveTable(zlimdb* zdb, const String& table, bool_t create, uint32_t& tableId)
+{
+  if(!table.isEmpty() && String::isDigit(*(const char_t*)table))
+    return tableId = table.toUInt(), true;
+  if(zlimdb_find_table(zdb, table, &tableId) == 0)
+    return true;
+  return create && zlimdb_add_table(zdb, table, &tableId) == 0;
+}
+
+uint_t Replicator::threadProc(void_t* param)
+{
+  Replicator* replicator = (Replicator*)param;
+  replicator->process();
+  replicator->running = false;
+  return 0;
+}
+
+void_t Replicator::process()
+{
+  startTime = reportTime = Time::ticks();
+  nextReport = startTime + reportInterval;
+  reportEntityCount = reportByteCount = 0;
+
+  // a subscription delivers the same initial responses as a query and keeps sending updates afterwards
+  int result = follow ? zlimdb_subscribe(source, sourceTableId, zlimdb_query_type_all, 0, zlimdb_subscribe_flag_none) :
+    zlimdb_query(source, sourceTableId, zlimdb_query_type_all, 0);
+  if(result != 0)
+    error = Connection::getZlimdbError();
+  else
+  {
+    char_t buffer[ZLIMDB_MAX_MESSAGE_SIZE];
+    while(keepRunning && error.isEmpty() && zlimdb_get_response(source, (zlimdb_header*)buffer, ZLIMDB_MAX_MESSAGE_SIZE) == 0)
+    {
+      for(const zlimdb_entity* entity = zlimdb_get_first_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity));
+          entity;
+          entity = zlimdb_get_next_entity((zlimdb_header*)buffer, sizeof(zlimdb_entity), entity))
+        if(!add(*entity))
+          break;
+      report(false);
+    }
+    if(keepRunning && error.isEmpty() && zlimdb_errno() != zlimdb_local_error_none)
+      error = Connection::getZlimdbError();
+  }
+
+  if(follow)
+    while(keepRunning && error.isEmpty())
+    {
+      if(zlimdb_exec(source, followTimeout) != 0)
+        switch(zlimdb_errno())
+        {
+        case zlimdb_local_error_interrupted:
+        case zlimdb_local_error_timeout:
+          break;
+        default:
+          error = Connection::getZlimdbError();
+          break;
+        }
+      if(!adder.flush() && error.isEmpty())
+        error = adder.getLastError();
+      report(false);
+    }
+
+  if(!adder.finish() && error.isEmpty())
+    error = adder.getLastError();
+  report(true);
+  if(!error.isEmpty() && keepRunning)
+    Console::errorf("error: Replication %s failed: %s\n", (const char_t*)getName(), (const char_t*)error);
+}
+
+void_t Replicator::zlimdbCallback(const void_t* data)
+{
+  const zlimdb_header* header = (const zlimdb_header*)data;
+  if(header->message_type != zlimdb_message_add_request || header->size < sizeof(zlimdb_add_request) + sizeof(zlimdb_entity))
+    return;
+  const zlimdb_add_request* addRequest = (const zlimdb_add_request*)header;
+  const zlimdb_entity* entity = (const zlimdb_entity*)(addRequest + 1);
+  if(addRequest->table_id != sourceTableId || entity->size < sizeof(zlimdb_entity) || sizeof(zlimdb_add_request) + entity->size > header->size)
+    return;
+  if(error.isEmpty())
+    add(*entity);
+}
+
+bool_t Replicator::add(const zlimdb_entity& entity)
+{
+  // the entity is forwarded as received, only its id is left to the destination
+  lastEntityTime = entity.time;
+  if(!adder.add(entity))
+    return error = adder.getLastError(), false;
+  return true;
+}
+
+void_t Replicator::report(bool_t final)
+{
+  int64_t now = Time::ticks();
+  if(!final && now < nextReport)
+    return;
+  uint64_t entityCount = adder.getEntityCount();
+  uint64_t byteCount = adder.getByteCount();
+  if(final)
+  {
+    double duration = (double)(now - startTime) / 1000.;
+    if(duration <= 0.)
+      duration = 0.001;
+    Console::printf("replicated %s: %llu entities (%llu bytes) in %.3f s, %.0f entities/s, %.2f MB/s\n", (const char_t*)getName(),
+      entityCount, byteCount, duration, (double)entityCount / duration, (double)byteCount / duration / (1024. * 1024.));
+    return;
+  }
+  double duration = (double)(now - reportTime) / 1000.;
+  int64_t lag = lastEntityTime ? Time::time() - (int64_t)lastEntityTime : 0;
+  Console::printf("replicate %s: %llu entities, %.0f entities/s, %.2f MB/s, lag %lld ms\n", (const char_t*)getName(), entityCount,
+    (double)(entityCount - reportEntityCount) / duration, (double)(byteCount - reportByteCount) / duration / (1024. * 1024.), lag);
+  reportEntityCount = entityCount;
+  reportByteCount = byteCount;
+  reportTime = now;
+  nextReport = now + reportInterval;
+}
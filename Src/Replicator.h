@@ -0,0 +1,63 @@
+
+#pragma once
+
+#include <nstd/Thread.h>
+
+#include "Connection.h"
+#include "BulkAdder.h"
+
+class Replicator
+{
+public:
+  Replicator(const String& sourceAddress, const String& sourceTable, const String& destinationAddress, const String& destinationTable,
+    bool_t follow, uint_t connections);
+  ~Replicator();
+
+  String getLastError() const {return error;}
+
+  bool_t start(const String& userName, const String& password);
+  void_t stop();
+
+  bool_t isRunning() const {return running;}
+  String getName() const;
+
+private:
+  String error;
+  String sourceAddress;
+  String sourceTable;
+  String destinationAddress;
+  String destinationTable;
+  bool_t follow;
+  uint_t connections;
+  uint32_t sourceTableId;
+  uint32_t destinationTableId;
+  Connection source;
+  BulkAdder adder;
+  Thread thread;
+  volatile bool_t keepRunning;
+  volatile bool_t running;
+  int64_t startTime;
+  uint64_t lastEntityTime;
+  int64_t nextReport;
+  uint64_t reportEntityCount;
+  uint64_t reportByteCount;
+  int64_t reportTime;
+
+private:
+  enum
+  {
+    reportInterval = 5000,
+    followTimeout = 100,
+  };
+
+private:
+  static uint_t threadProc(void_t* param);
+  static void_t zlimdbCallback(void_t* userData, const void_t* data) {((Replicator*)userData)->zlimdbCallback(data);}
+
+  void_t zlimdbCallback(const void_t* data);
+  void_t process();
+  bool_t add(const zlimdb_entity& entity);
+  void_t report(bool_t final);
+
+  static bool_t resolveTable(zlimdb* zdb, const String& table, bool_t create, uint32_t& tableId);
+};
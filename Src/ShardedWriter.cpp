@@ -0,0 +1,81 @@
+
+#include "Tools/Fnv.h"
+
+#include "ShardedWriter.h"
+
+ShardedWriter::~ShardedWriter()
+{
+  for(Array<BulkAdder*>::Iterator i = adders.begin(), end = adders.end(); i != end; ++i)
+    delete *i;
+}
+
+String ShardedWriter::getShardName(const String& name, uint_t shard)
+{
+  String result;
+  result.printf("%s/shard-%u", (const char_t*)name, shard);
+  return result;
+}
+
+bool_t ShardedWriter::start(const String& userName, const String& password, const String& address, const Array<uint32_t>& tableIds)
+{
+  // each shard gets its own adder with a single connection, so the shards are written in parallel while each shard stays time ordered for the merged query
+  for(size_t i = 0; i < tableIds.size(); ++i)
+  {
+    BulkAdder* adder = new BulkAdder;
+    adders.append(adder);
+    if(!adder->start(userName, password, address, tableIds[i], 1))
+      return error = adder->getLastError(), false;
+  }
+  return true;
+}
+
+BulkAdder& ShardedWriter::route(const void_t* data, size_t size)
+{
+  uint_t shard;
+  if(routing == keyRouting)
+    shard = (uint_t)(hashKey((const byte_t*)data, size) % adders.size());
+  else
+  {
+    shard = nextShard;
+    if(++nextShard == adders.size())
+      nextShard = 0;
+  }
+  return *adders[shard];
+}
+
+bool_t ShardedWriter::finish()
+{
+  bool_t result = true;
+  for(Array<BulkAdder*>::Iterator i = adders.begin(), end = adders.end(); i != end; ++i)
+    if(!(*i)->finish() && result)
+    {
+      error = (*i)->getLastError();
+      result = false;
+    }
+  return result;
+}
+
+uint64_t ShardedWriter::getEntityCount() const
+{
+  uint64_t count = 0;
+  for(Array<BulkAdder*>::Iterator i = adders.begin(), end = adders.end(); i != end; ++i)
+    count += (*i)->getEntityCount();
+  return count;
+}
+
+uint64_t ShardedWriter::getByteCount() const
+{
+  uint64_t count = 0;
+  for(Array<BulkAdder*>::Iterator i = adders.begin(), end = adders.end(); i != end; ++i)
+    count += (*i)->getByteCount();
+  return count;
+}
+
+uint64_t ShardedWriter::hashKey(const byte_t* data, size_t size)
+{
+  // the key ends at the first separator, records without one are hashed as a whole
+  const byte_t* key = data;
+  for(const byte_t* end = data + size; key < end && *key != ',' && *key != ' ' && *key != '\t'; ++key)
+    ;
+  return Fnv::hash(Fnv::offset, data, key - data);
+}
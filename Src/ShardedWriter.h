@@ -0,0 +1,44 @@
+
+#pragma once
+
+#include <nstd/Array.h>
+#include <nstd/String.h>
+
+#include "BulkAdder.h"
+
+class ShardedWriter
+{
+public:
+  enum Routing
+  {
+    roundRobinRouting,
+    keyRouting, // hash of the leading key field of a record
+  };
+
+public:
+  ShardedWriter(Routing routing) : routing(routing), nextShard(0) {}
+  ~ShardedWriter();
+
+  String getLastError() const {return error;}
+
+  bool_t start(const String& userName, const String& password, const String& address, const Array<uint32_t>& tableIds);
+
+  BulkAdder& route(const void_t* data, size_t size);
+
+  bool_t finish();
+
+  uint_t getShardCount() const {return (uint_t)adders.size();}
+  uint64_t getEntityCount() const;
+  uint64_t getByteCount() const;
+
+  static String getShardName(const String& name, uint_t shard);
+
+private:
+  String error;
+  Routing routing;
+  Array<BulkAdder*> adders;
+  uint_t nextShard;
+
+private:
+  static uint64_t hashKey(const byte_t* data, size_t size);
+};
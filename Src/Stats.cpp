@@ -0,0 +1,53 @@
+
+#include <nstd/Memory.h>
+
+#include "Stats.h"
+
+Stats::~Stats()
+{
+  for(Array<Block*>::Iterator i = blocks.begin(), end = blocks.end(); i != end; ++i)
+    delete *i;
+}
+
+Stats::Block* Stats::createBlock()
+{
+  Block* block = new Block;
+  Memory::zero(block->counters, sizeof(block->counters));
+  mutex.lock();
+  blocks.append(block);
+  mutex.unlock();
+  return block;
+}
+
+void_t Stats::merge(Counters (&result)[maxSlots])
+{
+  Memory::zero(result, sizeof(result));
+  mutex.lock();
+  for(Array<Block*>::Iterator i = blocks.begin(), end = blocks.end(); i != end; ++i)
+  {
+    const Counters* counters = (*i)->counters;
+    for(uint_t j = 0; j < maxSlots; ++j)
+    {
+      const Counters& src = counters[j];
+      Counters& dest = result[j];
+      dest.count += src.count;
+      dest.errors += src.errors;
+      dest.queueTime += src.queueTime;
+      dest.sendTime += src.sendTime;
+      dest.responseCount += src.responseCount;
+      dest.firstResponseTime += src.firstResponseTime;
+      dest.totalTime += src.totalTime;
+      dest.bytes += src.bytes;
+      dest.entities += src.entities;
+    }
+  }
+  mutex.unlock();
+}
+
+void_t Stats::reset()
+{
+  mutex.lock();
+  for(Array<Block*>::Iterator i = blocks.begin(), end = blocks.end(); i != end; ++i)
+    Memory::zero((*i)->counters, sizeof((*i)->counters));
+  mutex.unlock();
+}
@@ -0,0 +1,46 @@
+
+#pragma once
+
+#include <nstd/Mutex.h>
+#include <nstd/Array.h>
+
+class Stats
+{
+public:
+  enum
+  {
+    maxSlots = 64,
+  };
+
+  struct Counters
+  {
+    uint64_t count;
+    uint64_t errors;
+    uint64_t queueTime;
+    uint64_t sendTime;
+    uint64_t responseCount;
+    uint64_t firstResponseTime;
+    uint64_t totalTime;
+    uint64_t bytes;
+    uint64_t entities;
+  };
+
+  // counters of one thread, only that thread writes to them
+  class Block
+  {
+  public:
+    Counters counters[maxSlots];
+  };
+
+public:
+  ~Stats();
+
+  Block* createBlock();
+
+  void_t merge(Counters (&result)[maxSlots]);
+  void_t reset();
+
+private:
+  Mutex mutex;
+  Array<Block*> blocks;
+};
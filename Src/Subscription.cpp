@@ -0,0 +1,116 @@
+
+#include <nstd/Console.h>
+#include <nstd/Time.h>
+#include <nstd/Atomic.h>
+#include <nstd/Debug.h>
+#include <nstd/Memory.h>
+
+#include "Subscription.h"
+
+Subscription::Subscription(uint32_t tableId, Handler handler, void_t* userData, Policy policy, uint32_t queueSize) :
+  tableId(tableId), handler(handler), userData(userData), policy(policy),
+  queued(getCapacity(queueSize)), free(getCapacity(queueSize)), freeCount(getCapacity(queueSize)), queuedSize(0), keepRunning(false), lastId(0), receivedId(0), stalled(false)
+{
+  uint32_t capacity = getCapacity(queueSize);
+  slots = new Slot[capacity];
+  for(uint32_t i = 0; i < capacity; ++i)
+    VERIFY(free.push(&slots[i]));
+  Memory::zero(&counters, sizeof(counters));
+}
+
+Subscription::~Subscription()
+{
+  stop();
+  delete[] slots;
+}
+
+bool_t Subscription::start()
+{
+  keepRunning = true;
+  if(!thread.start(threadProc, this))
+    return keepRunning = false, false;
+  return true;
+}
+
+void_t Subscription::stop()
+{
+  if(!keepRunning)
+    return;
+  keepRunning = false;
+  queuedCount.signal();
+  thread.join();
+}
+
+bool_t Subscription::push(const void_t* data, size_t size)
+{
+  if(policy == dropPolicy)
+  {
+    if(!freeCount.tryWait())
+      return ++counters.dropped, false;
+  }
+  else if(!freeCount.wait(maxBlockTime))
+  {
+    // the push runs on the client's worker, so blocking any longer would also stall the unsubscribe that could resolve this
+    if(!stalled)
+      Console::errorf("warning: Handler of table %u is stalled, dropping updates\n", tableId);
+    stalled = true;
+    return ++counters.dropped, false;
+  }
+  stalled = false;
+  Slot* slot;
+  VERIFY(free.pop(slot));
+  slot->data.assign((const byte_t*)data, size);
+
+  // remember the last queued id, a resumed subscription continues after it
+  Update update;
+  update.data = slot->data;
+  update.end = update.data + size;
+  for(const zlimdb_entity* entity = update.getFirstEntity(); entity; entity = update.getNextEntity(entity))
+    receivedId = entity->id;
+  slot->receiveTime = Time::microTicks();
+  uint32_t queueLength = Atomic::increment(queuedSize);
+  if(queueLength > counters.maxQueued)
+    counters.maxQueued = queueLength;
+  VERIFY(queued.push(slot));
+  queuedCount.signal();
+  return true;
+}
+
+uint_t Subscription::threadProc(void_t* param)
+{
+  ((Subscription*)param)->process();
+  return 0;
+}
+
+void_t Subscription::process()
+{
+  Update update;
+  update.tableId = tableId;
+  for(Slot* slot;;)
+  {
+    queuedCount.wait();
+    if(!queued.pop(slot))
+    {
+      if(!keepRunning)
+        break; // queued updates are handled before the stop signal is seen
+      continue;
+    }
+    int64_t lag = Time::microTicks() - slot->receiveTime;
+    if(lag > counters.maxLag)
+      counters.maxLag = lag;
+    update.receiveTime = slot->receiveTime;
+    update.pending = queuedSize - 1;
+    update.data = slot->data;
+    update.end = update.data + slot->data.size();
+    ++counters.updates;
+    for(const zlimdb_entity* entity = update.getFirstEntity(); entity; entity = update.getNextEntity(entity))
+    {
+      ++counters.entities;
+      lastId = entity->id;
+    }
+    handler(userData, update);
+    Atomic::decrement(queuedSize);
+    VERIFY(free.push(slot));
+    freeCount.signal();
+  }
+}
@@ -0,0 +1,121 @@
+
+#pragma once
+
+#include <nstd/Buffer.h>
+#include <nstd/Thread.h>
+#include <nstd/Semaphore.h>
+
+#include <zlimdbprotocol.h>
+
+#include "Tools/LockFreeQueue.h"
+
+class Subscription
+{
+public:
+  enum Policy
+  {
+    blockPolicy, // stall the receiving connection until the handler caught up, but for at most maxBlockTime per update
+    dropPolicy, // discard updates that do not fit into the queue
+  };
+
+  class Update
+  {
+  public:
+    uint32_t tableId;
+    int64_t receiveTime;
+    uint32_t pending; // updates queued behind this one, a handler may hold back its output while more are coming
+
+  public:
+    const zlimdb_entity* getFirstEntity() const {return getEntity(data);}
+    const zlimdb_entity* getNextEntity(const zlimdb_entity* entity) const {return getEntity((const byte_t*)entity + entity->size);}
+
+  private:
+    const byte_t* data;
+    const byte_t* end;
+
+  private:
+    const zlimdb_entity* getEntity(const byte_t* pos) const
+    {
+      if(pos + sizeof(zlimdb_entity) > end)
+        return 0;
+      const zlimdb_entity* entity = (const zlimdb_entity*)pos;
+      if(entity->size < sizeof(zlimdb_entity) || pos + entity->size > end)
+        return 0;
+      return entity;
+    }
+
+    friend class Subscription;
+  };
+
+  typedef void_t (*Handler)(void_t* userData, const Update& update);
+
+  static const int64_t maxBlockTime = 1000; // milliseconds, a stalled handler must not keep the client from handling its actions
+
+  struct Counters
+  {
+    uint64_t updates;
+    uint64_t entities;
+    uint64_t dropped;
+    uint64_t maxQueued;
+    int64_t maxLag; // microseconds between receiving and handling an update
+  };
+
+public:
+  Subscription(uint32_t tableId, Handler handler, void_t* userData, Policy policy, uint32_t queueSize);
+  ~Subscription();
+
+  bool_t start();
+  void_t stop();
+
+  bool_t push(const void_t* data, size_t size);
+
+  uint32_t getTableId() const {return tableId;}
+  Policy getPolicy() const {return policy;}
+  Handler getHandler() const {return handler;}
+  void_t* getUserData() const {return userData;}
+  const Counters& getCounters() const {return counters;}
+  uint64_t getLastId() const {return lastId;}
+  uint64_t getReceivedId() const {return receivedId;}
+
+private:
+  struct Slot
+  {
+    Buffer data;
+    int64_t receiveTime;
+  };
+
+private:
+  uint32_t tableId;
+  Handler handler;
+  void_t* userData;
+  Policy policy;
+  Slot* slots;
+  LockFreeQueue<Slot*> queued;
+  LockFreeQueue<Slot*> free;
+  Semaphore queuedCount;
+  Semaphore freeCount;
+  volatile uint32_t queuedSize;
+  Thread thread;
+  volatile bool_t keepRunning;
+  Counters counters;
+  volatile uint64_t lastId;
+  uint64_t receivedId;
+  bool_t stalled;
+
+private:
+  static uint_t threadProc(void_t* param);
+
+  static uint32_t getCapacity(uint32_t queueSize)
+  {
+    uint32_t capacity = 2;
+    while(capacity < queueSize)
+      capacity <<= 1;
+    return capacity;
+  }
+
+  void_t process();
+
+private:
+  Subscription(const Subscription&);
+  Subscription& operator=(const Subscription&);
+};
@@ -0,0 +1,66 @@
+
+#include <nstd/Memory.h>
+
+#include "TableCache.h"
+
+TableCache::~TableCache()
+{
+  clear();
+}
+
+bool_t TableCache::add(const zlimdb_table_entity& table)
+{
+  if(table.entity.size < sizeof(zlimdb_table_entity) || sizeof(zlimdb_table_entity) + table.name_size > table.entity.size)
+    return false;
+  remove((uint32_t)table.entity.id);
+  zlimdb_table_entity* copy = (zlimdb_table_entity*)new byte_t[table.entity.size];
+  Memory::copy(copy, &table, table.entity.size);
+  tables.append((uint32_t)table.entity.id, copy);
+  tableIds.append(String((const char_t*)(&table + 1), table.name_size), (uint32_t)table.entity.id);
+  return true;
+}
+
+void_t TableCache::add(uint32_t tableId, const String& name)
+{
+  // build the entity the server would report, so that locally created tables look like queried ones
+  byte_t buffer[sizeof(zlimdb_table_entity) + ZLIMDB_MAX_ENTITY_SIZE];
+  zlimdb_table_entity* table = (zlimdb_table_entity*)buffer;
+  size_t nameSize = name.length();
+  if(sizeof(zlimdb_table_entity) + nameSize > ZLIMDB_MAX_ENTITY_SIZE)
+    return;
+  table->entity.id = tableId;
+  table->entity.time = 0;
+  table->entity.size = (uint16_t)(sizeof(zlimdb_table_entity) + nameSize);
+  table->name_size = (uint16_t)nameSize;
+  Memory::copy(table + 1, (const char_t*)name, nameSize);
+  add(*table);
+}
+
+void_t TableCache::remove(uint32_t tableId)
+{
+  HashMap<uint32_t, zlimdb_table_entity*>::Iterator it = tables.find(tableId);
+  if(it == tables.end())
+    return;
+  zlimdb_table_entity* table = *it;
+  tableIds.remove(String((const char_t*)(table + 1), table->name_size));
+  delete[] (byte_t*)table;
+  tables.remove(it);
+}
+
+void_t TableCache::clear()
+{
+  for(HashMap<uint32_t, zlimdb_table_entity*>::Iterator i = tables.begin(), end = tables.end(); i != end; ++i)
+    delete[] (byte_t*)*i;
+  tables.clear();
+  tableIds.clear();
+  loaded = false;
+}
+
+bool_t TableCache::find(const String& name, uint32_t& tableId) const
+{
+  HashMap<String, uint32_t>::Iterator it = tableIds.find(name);
+  if(it == tableIds.end())
+    return false;
+  tableId = *it;
+  return true;
+}
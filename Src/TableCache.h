@@ -0,0 +1,35 @@
+
+#pragma once
+
+#include <nstd/HashMap.h>
+#include <nstd/String.h>
+
+#include <zlimdbprotocol.h>
+
+class TableCache
+{
+public:
+  typedef HashMap<uint32_t, zlimdb_table_entity*>::Iterator Iterator;
+
+public:
+  TableCache() : loaded(false) {}
+  ~TableCache();
+
+  bool_t isLoaded() const {return loaded;}
+  void_t setLoaded() {loaded = true;}
+
+  bool_t add(const zlimdb_table_entity& table);
+  void_t add(uint32_t tableId, const String& name);
+  void_t remove(uint32_t tableId);
+  void_t clear();
+
+  bool_t find(const String& name, uint32_t& tableId) const;
+
+  Iterator begin() const {return tables.begin();}
+  Iterator end() const {return tables.end();}
+
+private:
+  bool_t loaded;
+  HashMap<uint32_t, zlimdb_table_entity*> tables;
+  HashMap<String, uint32_t> tableIds;
+};
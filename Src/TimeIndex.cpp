@@ -0,0 +1,81 @@
+
+#include <nstd/Memory.h>
+
+#include "TimeIndex.h"
+
+TimeIndex::~TimeIndex()
+{
+  clear();
+}
+
+TimeIndex::Table& TimeIndex::getTable(uint32_t tableId)
+{
+  HashMap<uint32_t, Table*>::Iterator it = tables.find(tableId);
+  if(it != tables.end())
+    return **it;
+  return *tables.append(tableId, new Table);
+}
+
+const TimeIndex::Table* TimeIndex::findTable(uint32_t tableId) const
+{
+  HashMap<uint32_t, Table*>::Iterator it = tables.find(tableId);
+  if(it == tables.end())
+    return 0;
+  return *it;
+}
+
+void_t TimeIndex::clear()
+{
+  for(HashMap<uint32_t, Table*>::Iterator i = tables.begin(), end = tables.end(); i != end; ++i)
+    delete *i;
+  tables.clear();
+}
+
+size_t TimeIndex::Table::lowerBound(uint64_t id) const
+{
+  size_t low = 0, high = samples.size();
+  while(low < high)
+  {
+    size_t mid = (low + high) / 2;
+    if(samples[mid].id < id)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return low;
+}
+
+void_t TimeIndex::Table::insert(uint64_t id, int64_t time)
+{
+  // keep samples at least one interval apart when filling gaps left by earlier queries
+  size_t pos = lowerBound(id);
+  if(pos < samples.size() && samples[pos].id - id < sampleInterval)
+    return;
+  if(pos > 0 && id - samples[pos - 1].id < sampleInterval)
+    return;
+  Sample sample = {id, time};
+  samples.append(sample);
+  Sample* data = &samples[0];
+  Memory::move(data + pos + 1, data + pos, (samples.size() - 1 - pos) * sizeof(Sample));
+  data[pos] = sample;
+}
+
+uint64_t TimeIndex::Table::findSinceId(int64_t time) const
+{
+  // find the last sample before the given time, entities after this sample may be in range
+  size_t low = 0, high = samples.size();
+  while(low < high)
+  {
+    size_t mid = (low + high) / 2;
+    if(samples[mid].time < time)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  // entity times are not strictly ordered by id, so back off further while a preceding sample is not strictly before the time
+  while(low > 0 && samples[low - 1].time >= time)
+    --low;
+  if(low == 0)
+    return 0;
+  return samples[low - 1].id;
+}
@@ -0,0 +1,73 @@
+
+#pragma once
+
+#include <nstd/HashMap.h>
+#include <nstd/Array.h>
+
+#include <zlimdbprotocol.h>
+
+class TimeIndex
+{
+public:
+  class Table
+  {
+  public:
+    Table() : nextSampleId(0), lastId(0), lastTime(0) {}
+
+    void_t add(const zlimdb_entity& entity)
+    {
+      if(entity.id >= nextSampleId)
+      {
+        Sample sample = {entity.id, (int64_t)entity.time};
+        samples.append(sample);
+        nextSampleId = entity.id + sampleInterval;
+      }
+      else if(!samples.isEmpty() && entity.id < samples.back().id)
+        insert(entity.id, entity.time);
+      if(entity.id > lastId)
+      {
+        lastId = entity.id;
+        lastTime = entity.time;
+      }
+    }
+
+    uint64_t findSinceId(int64_t time) const;
+
+    uint64_t getLastId() const {return lastId;}
+    int64_t getLastTime() const {return lastTime;}
+    uint64_t getSampleCount() const {return samples.size();}
+
+  private:
+    struct Sample
+    {
+      uint64_t id;
+      int64_t time;
+    };
+
+    enum
+    {
+      sampleInterval = 4096,
+    };
+
+  private:
+    Array<Sample> samples;
+    uint64_t nextSampleId;
+    uint64_t lastId;
+    int64_t lastTime;
+
+  private:
+    void_t insert(uint64_t id, int64_t time);
+    size_t lowerBound(uint64_t id) const;
+  };
+
+public:
+  ~TimeIndex();
+
+  Table& getTable(uint32_t tableId);
+  const Table* findTable(uint32_t tableId) const;
+
+  void_t clear();
+
+private:
+  HashMap<uint32_t, Table*> tables;
+};
@@ -0,0 +1,85 @@
+
+#include "Aggregator.h"
+
+Aggregator::Aggregator(int64_t window, int64_t fromTime, int64_t toTime, Handler handler, void_t* userData) :
+  window(window > 0 ? window : 1), fromTime(fromTime), toTime(toTime), handler(handler), userData(userData), bucketEnd(0), buckets(0), late(0)
+{
+  bucket.count = 0;
+}
+
+void_t Aggregator::open(int64_t time, uint64_t id)
+{
+  int64_t offset = time % window;
+  bucket.startTime = time - (offset < 0 ? offset + window : offset);
+  bucket.count = 0;
+  bucket.sizeSum = 0;
+  bucket.minSize = 0xffffffff;
+  bucket.maxSize = 0;
+  bucket.firstId = id;
+  bucketEnd = bucket.startTime + window;
+}
+
+bool_t Aggregator::add(const void_t* data, size_t size)
+{
+  const byte_t* pos = (const byte_t*)data;
+  const byte_t* end = pos + size;
+  while(pos + sizeof(zlimdb_entity) <= end)
+  {
+    const zlimdb_entity* entity = (const zlimdb_entity*)pos;
+    if(entity->size < sizeof(zlimdb_entity) || pos + entity->size > end)
+      break;
+    int64_t time = (int64_t)entity->time;
+    if(time < fromTime)
+    {
+      pos += entity->size;
+      continue;
+    }
+    if(time > toTime)
+      return flush(), false;
+    if(!bucket.count || time >= bucketEnd)
+    {
+      flush();
+      open(time, entity->id);
+    }
+
+    // fold the run of entities that falls into the open bucket with local accumulators
+    uint64_t count = 0, sizeSum = 0;
+    uint32_t minSize = bucket.minSize, maxSize = bucket.maxSize;
+    uint64_t lastId = entity->id;
+    do
+    {
+      uint32_t entitySize = entity->size;
+      sizeSum += entitySize;
+      if(entitySize < minSize)
+        minSize = entitySize;
+      if(entitySize > maxSize)
+        maxSize = entitySize;
+      if(time < bucket.startTime)
+        ++late; // older entities are counted in the open bucket, since closed buckets are not kept
+      lastId = entity->id;
+      ++count;
+      pos += entitySize;
+      if(pos + sizeof(zlimdb_entity) > end)
+        break;
+      entity = (const zlimdb_entity*)pos;
+      if(entity->size < sizeof(zlimdb_entity) || pos + entity->size > end)
+        break;
+      time = (int64_t)entity->time;
+    } while(time < bucketEnd && time >= fromTime && time <= toTime);
+    bucket.count += count;
+    bucket.sizeSum += sizeSum;
+    bucket.minSize = minSize;
+    bucket.maxSize = maxSize;
+    bucket.lastId = lastId;
+  }
+  return true;
+}
+
+void_t Aggregator::flush()
+{
+  if(!bucket.count)
+    return;
+  handler(userData, bucket);
+  ++buckets;
+  bucket.count = 0;
+}
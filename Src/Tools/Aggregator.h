@@ -0,0 +1,50 @@
+
+#pragma once
+
+#include <nstd/Base.h>
+
+#include <zlimdbprotocol.h>
+
+// folds a time ordered entity stream into fixed size time buckets, only the open bucket is kept
+class Aggregator
+{
+public:
+  struct Bucket
+  {
+    int64_t startTime;
+    uint64_t count;
+    uint64_t sizeSum;
+    uint32_t minSize;
+    uint32_t maxSize;
+    uint64_t firstId;
+    uint64_t lastId;
+  };
+
+  typedef void_t (*Handler)(void_t* userData, const Bucket& bucket);
+
+public:
+  Aggregator(int64_t window, int64_t fromTime, int64_t toTime, Handler handler, void_t* userData);
+
+  bool_t add(const void_t* data, size_t size);
+  void_t flush();
+
+  int64_t getWindow() const {return window;}
+  int64_t getFromTime() const {return fromTime;}
+  int64_t getToTime() const {return toTime;}
+  uint64_t getBucketCount() const {return buckets;}
+  uint64_t getLateCount() const {return late;}
+
+private:
+  int64_t window;
+  int64_t fromTime;
+  int64_t toTime;
+  Handler handler;
+  void_t* userData;
+  Bucket bucket;
+  int64_t bucketEnd;
+  uint64_t buckets;
+  uint64_t late;
+
+private:
+  void_t open(int64_t time, uint64_t id);
+};
@@ -0,0 +1,71 @@
+
+#include <nstd/Error.h>
+#include <nstd/Memory.h>
+
+#include <lz4.h>
+
+#include "BlockFile.h"
+
+const char_t BlockFile::magic[] = "zlimdbx1";
+
+bool_t BlockFile::create(const String& fileName)
+{
+  if(!file.open(fileName, File::writeFlag))
+    return error = Error::getErrorString(), false;
+  if(file.write(magic, sizeof(magic) - 1) != sizeof(magic) - 1)
+    return error = Error::getErrorString(), false;
+  compressed.resize(sizeof(FrameHeader) + LZ4_compressBound(ZLIMDB_MAX_MESSAGE_SIZE));
+  rawSize = compressedSize = 0;
+  return true;
+}
+
+bool_t BlockFile::open(const String& fileName)
+{
+  if(!file.open(fileName))
+    return error = Error::getErrorString(), false;
+  char_t fileMagic[sizeof(magic) - 1];
+  if(file.read(fileMagic, sizeof(fileMagic)) != sizeof(fileMagic) || Memory::compare(fileMagic, magic, sizeof(fileMagic)) != 0)
+    return error = "Unknown file format", false;
+  compressed.resize(sizeof(FrameHeader) + LZ4_compressBound(ZLIMDB_MAX_MESSAGE_SIZE));
+  block.resize(ZLIMDB_MAX_MESSAGE_SIZE);
+  rawSize = compressedSize = 0;
+  return true;
+}
+
+bool_t BlockFile::write(const zlimdb_header& header)
+{
+  // the message block is compressed as received, so writing a query response does not touch the individual entities
+  FrameHeader* frame = (FrameHeader*)(byte_t*)compressed;
+  int result = LZ4_compress_limitedOutput((const char*)&header, (char*)(frame + 1), header.size, (int)(compressed.size() - sizeof(FrameHeader)));
+  if(result <= 0)
+    return error = "Could not compress data", false;
+  frame->rawSize = header.size;
+  frame->compressedSize = result;
+  size_t frameSize = sizeof(FrameHeader) + result;
+  if(file.write(frame, frameSize) != (ssize_t)frameSize)
+    return error = Error::getErrorString(), false;
+  rawSize += header.size;
+  compressedSize += frameSize;
+  return true;
+}
+
+const zlimdb_header* BlockFile::read()
+{
+  FrameHeader frame;
+  ssize_t result = file.read(&frame, sizeof(frame));
+  if(result == 0)
+    return error.clear(), (const zlimdb_header*)0;
+  if(result != sizeof(frame) || frame.rawSize < sizeof(zlimdb_header) || frame.rawSize > block.size() ||
+     frame.compressedSize > compressed.size())
+    return error = "Corrupt file", (const zlimdb_header*)0;
+  if(file.read((byte_t*)compressed, frame.compressedSize) != (ssize_t)frame.compressedSize)
+    return error = "Unexpected end of file", (const zlimdb_header*)0;
+  if(LZ4_decompress_safe((const char*)(const byte_t*)compressed, (char*)(byte_t*)block, frame.compressedSize, frame.rawSize) != (int)frame.rawSize)
+    return error = "Corrupt file", (const zlimdb_header*)0;
+  const zlimdb_header* header = (const zlimdb_header*)(const byte_t*)block;
+  if(header->size != frame.rawSize)
+    return error = "Corrupt file", (const zlimdb_header*)0;
+  rawSize += frame.rawSize;
+  compressedSize += sizeof(frame) + frame.compressedSize;
+  return header;
+}
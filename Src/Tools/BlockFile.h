@@ -0,0 +1,42 @@
+
+#pragma once
+
+#include <nstd/File.h>
+#include <nstd/Buffer.h>
+
+#include <zlimdbprotocol.h>
+
+class BlockFile
+{
+public:
+  BlockFile() : rawSize(0), compressedSize(0) {}
+
+  String getLastError() const {return error;}
+
+  bool_t create(const String& file);
+  bool_t open(const String& file);
+  void_t close() {file.close();}
+
+  bool_t write(const zlimdb_header& header);
+  const zlimdb_header* read();
+
+  uint64_t getRawSize() const {return rawSize;}
+  uint64_t getCompressedSize() const {return compressedSize;}
+
+private:
+  static const char_t magic[];
+
+  struct FrameHeader
+  {
+    uint32_t rawSize;
+    uint32_t compressedSize;
+  };
+
+private:
+  File file;
+  String error;
+  Buffer compressed;
+  Buffer block;
+  uint64_t rawSize;
+  uint64_t compressedSize;
+};
@@ -0,0 +1,64 @@
+
+#pragma once
+
+#include <nstd/Debug.h>
+
+#include "Word.h"
+
+template<typename H> class CommandTable
+{
+public:
+  CommandTable() : count(0)
+  {
+    for(size_t i = 0; i < capacity; ++i)
+      slots[i].name = 0;
+  }
+
+  void_t add(const char_t* name, H handler)
+  {
+    size_t length = String::length(name);
+    for(size_t i = Word::hash(name, length);; ++i)
+    {
+      Slot& slot = slots[i & (capacity - 1)];
+      if(!slot.name)
+      {
+        ++count;
+        ASSERT(count < capacity / 2);
+        slot.name = name;
+        slot.length = length;
+        slot.handler = handler;
+        return;
+      }
+    }
+  }
+
+  bool_t find(const Word& name, H& handler) const
+  {
+    // open addressing with linear probing, the table is kept at most half full
+    for(size_t i = name.hash();; ++i)
+    {
+      const Slot& slot = slots[i & (capacity - 1)];
+      if(!slot.name)
+        return false;
+      if(slot.length == name.length && name == slot.name)
+        return handler = slot.handler, true;
+    }
+  }
+
+private:
+  enum
+  {
+    capacity = 128,
+  };
+
+  struct Slot
+  {
+    const char_t* name;
+    size_t length;
+    H handler;
+  };
+
+private:
+  Slot slots[capacity];
+  size_t count;
+};
@@ -0,0 +1,27 @@
+
+#pragma once
+
+#include <nstd/Base.h>
+
+// 64-bit FNV-1a, used where a fast hash of a few bytes is needed and its value does not have to be cryptographically strong
+class Fnv
+{
+public:
+  static const uint64_t offset = 14695981039346656037ULL;
+  static const uint64_t prime = 1099511628211ULL;
+
+  static uint64_t hash(uint64_t hash, const void_t* data, size_t size)
+  {
+    for(const byte_t* i = (const byte_t*)data, * end = i + size; i < end; ++i)
+      hash = (hash ^ *i) * prime;
+    return hash;
+  }
+
+  static uint64_t hash(uint64_t hash, uint64_t value)
+  {
+    // byte wise in little endian order, so the result does not depend on the platform
+    for(int i = 0; i < 8; ++i, value >>= 8)
+      hash = (hash ^ (value & 0xff)) * prime;
+    return hash;
+  }
+};
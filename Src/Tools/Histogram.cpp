@@ -0,0 +1,54 @@
+
+#include <nstd/Memory.h>
+
+#include "Histogram.h"
+
+void_t Histogram::reset()
+{
+  Memory::zero(counts, sizeof(counts));
+  count = 0;
+  sum = 0;
+  min = ~(uint64_t)0;
+  max = 0;
+}
+
+void_t Histogram::merge(const Histogram& other)
+{
+  for(uint_t i = 0; i < bucketCount; ++i)
+    counts[i] += other.counts[i];
+  count += other.count;
+  sum += other.sum;
+  if(other.min < min)
+    min = other.min;
+  if(other.max > max)
+    max = other.max;
+}
+
+uint64_t Histogram::getPercentile(double percentile) const
+{
+  if(!count)
+    return 0;
+  uint64_t target = (uint64_t)((double)count * percentile / 100. + 0.5);
+  if(target < 1)
+    target = 1;
+  uint64_t total = 0;
+  for(uint_t i = 0; i < bucketCount; ++i)
+  {
+    total += counts[i];
+    if(total >= target)
+    {
+      uint64_t value = getValue(i);
+      return value > max ? max : value;
+    }
+  }
+  return max;
+}
+
+uint64_t Histogram::getValue(uint_t index)
+{
+  if(index < subBucketCount)
+    return index;
+  uint_t exponent = (index - subBucketCount) / subBucketHalfCount + 1;
+  uint64_t mantissa = (index - subBucketCount) % subBucketHalfCount + subBucketHalfCount;
+  return ((mantissa + 1) << exponent) - 1; // highest value that falls into this bucket
+}
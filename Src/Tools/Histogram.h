@@ -0,0 +1,60 @@
+
+#pragma once
+
+#include <nstd/Base.h>
+
+class Histogram
+{
+public:
+  Histogram() {reset();}
+
+  void_t reset();
+
+  void_t add(uint64_t value)
+  {
+    ++counts[getIndex(value)];
+    ++count;
+    sum += value;
+    if(value < min)
+      min = value;
+    if(value > max)
+      max = value;
+  }
+
+  void_t merge(const Histogram& other);
+
+  uint64_t getCount() const {return count;}
+  uint64_t getMin() const {return count ? min : 0;}
+  uint64_t getMax() const {return max;}
+  double getMean() const {return count ? (double)sum / (double)count : 0.;}
+  uint64_t getPercentile(double percentile) const;
+
+private:
+  enum
+  {
+    subBucketBits = 7,
+    subBucketCount = 1 << subBucketBits,
+    subBucketHalfCount = subBucketCount / 2,
+    bucketCount = subBucketCount + (64 - subBucketBits + 1) * subBucketHalfCount,
+  };
+
+private:
+  uint64_t counts[bucketCount];
+  uint64_t count;
+  uint64_t sum;
+  uint64_t min;
+  uint64_t max;
+
+private:
+  static uint_t getIndex(uint64_t value)
+  {
+    if(value < subBucketCount)
+      return (uint_t)value;
+    uint_t exponent = 0;
+    for(uint64_t i = value >> subBucketBits; i; i >>= 1)
+      ++exponent;
+    return subBucketCount + (exponent - 1) * subBucketHalfCount + (uint_t)(value >> exponent) - subBucketHalfCount;
+  }
+
+  static uint64_t getValue(uint_t index);
+};
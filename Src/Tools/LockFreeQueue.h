@@ -0,0 +1,91 @@
+
+#pragma once
+
+#include <nstd/Atomic.h>
+#include <nstd/Debug.h>
+
+// bounded lock-free queue (Dmitry Vyukov's MPMC ring): the sequence number of a slot tells whether it is free or filled
+template<typename T> class LockFreeQueue
+{
+public:
+  explicit LockFreeQueue(uint32_t capacity) : mask(capacity - 1), cells(new Cell[capacity]), enqueuePos(0), dequeuePos(0)
+  {
+    ASSERT(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+    for(uint32_t i = 0; i < capacity; ++i)
+      cells[i].sequence = i;
+  }
+
+  ~LockFreeQueue() {delete[] cells;}
+
+  bool_t push(const T& value)
+  {
+    Cell* cell;
+    uint32_t pos = enqueuePos;
+    for(;;)
+    {
+      cell = &cells[pos & mask];
+      int32_t diff = (int32_t)(cell->sequence - pos);
+      if(diff == 0)
+      {
+        uint32_t prevPos = Atomic::compareAndSwap(enqueuePos, pos, pos + 1);
+        if(prevPos == pos)
+          break;
+        pos = prevPos;
+      }
+      else if(diff < 0)
+        return false; // full
+      else
+        pos = enqueuePos;
+    }
+    cell->value = value;
+    Atomic::swap(cell->sequence, pos + 1);
+    return true;
+  }
+
+  bool_t pop(T& value)
+  {
+    Cell* cell;
+    uint32_t pos = dequeuePos;
+    for(;;)
+    {
+      cell = &cells[pos & mask];
+      int32_t diff = (int32_t)(cell->sequence - (pos + 1));
+      if(diff == 0)
+      {
+        uint32_t prevPos = Atomic::compareAndSwap(dequeuePos, pos, pos + 1);
+        if(prevPos == pos)
+          break;
+        pos = prevPos;
+      }
+      else if(diff < 0)
+        return false; // empty
+      else
+        pos = dequeuePos;
+    }
+    value = cell->value;
+    cell->value = T();
+    Atomic::swap(cell->sequence, pos + mask + 1);
+    return true;
+  }
+
+  bool_t isEmpty() const {return (int32_t)(enqueuePos - dequeuePos) <= 0;}
+
+private:
+  struct Cell
+  {
+    volatile uint32_t sequence;
+    T value;
+  };
+
+private:
+  const uint32_t mask;
+  Cell* cells;
+  char_t pad1[64];
+  volatile uint32_t enqueuePos;
+  char_t pad2[64];
+  volatile uint32_t dequeuePos;
+
+private:
+  LockFreeQueue(const LockFreeQueue&);
+  LockFreeQueue& operator=(const LockFreeQueue&);
+};
@@ -0,0 +1,130 @@
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <nstd/Error.h>
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+MappedFile::MappedFile() : file(INVALID_HANDLE_VALUE), mapping(0), data(0), size(0) {}
+#else
+MappedFile::MappedFile() : fd(-1), data(0), size(0) {}
+#endif
+
+bool_t MappedFile::open(const String& fileName)
+{
+  close();
+#ifdef _WIN32
+  file = CreateFileA(fileName, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+  if(file == INVALID_HANDLE_VALUE)
+    return error = Error::getErrorString(), false;
+  LARGE_INTEGER fileSize;
+  if(!GetFileSizeEx(file, &fileSize))
+    return error = Error::getErrorString(), close(), false;
+  size = fileSize.QuadPart;
+#else
+  fd = ::open(fileName, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if(fd == -1)
+    return error = Error::getErrorString(), false;
+  struct stat buf;
+  if(fstat(fd, &buf) != 0)
+    return error = Error::getErrorString(), close(), false;
+  size = buf.st_size;
+#endif
+  if(size && !map())
+    return close(), false;
+  return true;
+}
+
+void_t MappedFile::close()
+{
+  unmap();
+#ifdef _WIN32
+  if(file != INVALID_HANDLE_VALUE)
+  {
+    CloseHandle(file);
+    file = INVALID_HANDLE_VALUE;
+  }
+#else
+  if(fd != -1)
+  {
+    ::close(fd);
+    fd = -1;
+  }
+#endif
+  size = 0;
+}
+
+bool_t MappedFile::resize(uint64_t newSize)
+{
+  unmap();
+#ifdef _WIN32
+  LARGE_INTEGER position;
+  position.QuadPart = newSize;
+  if(!SetFilePointerEx(file, position, NULL, FILE_BEGIN) || !SetEndOfFile(file))
+    return error = Error::getErrorString(), false;
+#else
+  if(ftruncate(fd, newSize) != 0)
+    return error = Error::getErrorString(), false;
+#endif
+  size = newSize;
+  return map();
+}
+
+bool_t MappedFile::sync()
+{
+  if(!data)
+    return true;
+#ifdef _WIN32
+  if(!FlushViewOfFile(data, 0))
+    return error = Error::getErrorString(), false;
+#else
+  if(msync(data, size, MS_ASYNC) != 0)
+    return error = Error::getErrorString(), false;
+#endif
+  return true;
+}
+
+bool_t MappedFile::map()
+{
+#ifdef _WIN32
+  mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, (DWORD)(size >> 32), (DWORD)size, NULL);
+  if(!mapping)
+    return error = Error::getErrorString(), false;
+  data = (byte_t*)MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, (SIZE_T)size);
+  if(!data)
+  {
+    error = Error::getErrorString();
+    CloseHandle(mapping);
+    mapping = 0;
+    return false;
+  }
+#else
+  void_t* result = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if(result == MAP_FAILED)
+    return error = Error::getErrorString(), false;
+  data = (byte_t*)result;
+#endif
+  return true;
+}
+
+void_t MappedFile::unmap()
+{
+  if(!data)
+    return;
+#ifdef _WIN32
+  UnmapViewOfFile(data);
+  CloseHandle(mapping);
+  mapping = 0;
+#else
+  munmap(data, size);
+#endif
+  data = 0;
+}
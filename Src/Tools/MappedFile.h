@@ -0,0 +1,38 @@
+
+#pragma once
+
+#include <nstd/String.h>
+
+class MappedFile
+{
+public:
+  MappedFile();
+  ~MappedFile() {close();}
+
+  String getLastError() const {return error;}
+
+  bool_t open(const String& file);
+  void_t close();
+  bool_t isOpen() const {return data != 0;}
+
+  bool_t resize(uint64_t size);
+  bool_t sync();
+
+  byte_t* getData() {return data;}
+  uint64_t getSize() const {return size;}
+
+private:
+  String error;
+#ifdef _WIN32
+  void_t* file;
+  void_t* mapping;
+#else
+  int fd;
+#endif
+  byte_t* data;
+  uint64_t size;
+
+private:
+  bool_t map();
+  void_t unmap();
+};
@@ -0,0 +1,191 @@
+
+#include <nstd/Console.h>
+#include <nstd/Memory.h>
+
+#include "OutputWriter.h"
+
+OutputWriter::OutputWriter() : format(textFormat)
+{
+  buffer = new char_t[bufferSize + 1]; // room for the terminator of the console output
+  pos = buffer;
+  end = buffer + bufferSize;
+}
+
+OutputWriter::~OutputWriter()
+{
+  flush();
+  delete[] buffer;
+}
+
+bool_t OutputWriter::parseFormat(const String& name, Format& format)
+{
+  if(name == "text")
+    format = textFormat;
+  else if(name == "csv")
+    format = csvFormat;
+  else if(name == "json")
+    format = jsonFormat;
+  else if(name == "raw")
+    format = rawFormat;
+  else
+    return false;
+  return true;
+}
+
+void_t OutputWriter::setFormat(Format format)
+{
+  flush();
+  this->format = format;
+}
+
+void_t OutputWriter::writeEntity(const zlimdb_entity& entity)
+{
+  switch(format)
+  {
+  case textFormat:
+    reserve(64);
+    appendLiteral("id=");
+    appendUInt(entity.id);
+    appendLiteral(", size=");
+    appendUInt(entity.size);
+    appendLiteral(", time=");
+    appendUInt(entity.time);
+    append('\n');
+    break;
+  case csvFormat:
+    reserve(64);
+    appendUInt(entity.id);
+    append(',');
+    appendUInt(entity.size);
+    append(',');
+    appendUInt(entity.time);
+    append('\n');
+    break;
+  case jsonFormat:
+    reserve(80);
+    appendLiteral("{\"id\":");
+    appendUInt(entity.id);
+    appendLiteral(",\"size\":");
+    appendUInt(entity.size);
+    appendLiteral(",\"time\":");
+    appendUInt(entity.time);
+    appendLiteral("}\n");
+    break;
+  case rawFormat:
+    append((const char_t*)&entity, entity.size);
+    break;
+  }
+}
+
+void_t OutputWriter::writeTable(const zlimdb_entity& entity, const char_t* name, size_t nameLength)
+{
+  switch(format)
+  {
+  case textFormat:
+    reserve(32);
+    appendUInt(entity.id, 6);
+    appendLiteral(": ");
+    append(name, nameLength);
+    reserve(1);
+    append('\n');
+    break;
+  case csvFormat:
+    reserve(32);
+    appendUInt(entity.id);
+    appendLiteral(",\"");
+    appendEscaped(name, nameLength);
+    reserve(2);
+    appendLiteral("\"\n");
+    break;
+  case jsonFormat:
+    reserve(32);
+    appendLiteral("{\"id\":");
+    appendUInt(entity.id);
+    appendLiteral(",\"name\":\"");
+    appendEscaped(name, nameLength);
+    reserve(3);
+    appendLiteral("\"}\n");
+    break;
+  case rawFormat:
+    append((const char_t*)&entity, entity.size);
+    break;
+  }
+}
+
+void_t OutputWriter::flush()
+{
+  if(pos == buffer)
+    return;
+  if(format == rawFormat)
+    writeRaw(buffer, pos - buffer);
+  else
+  {
+    *pos = '\0';
+    Console::print(buffer);
+  }
+  pos = buffer;
+}
+
+void_t OutputWriter::writeRaw(const char_t* data, size_t size)
+{
+  if(!rawOutput.isOpen())
+  {
+    // appending keeps a redirected output file from being truncated
+#ifdef _WIN32
+    String device("CONOUT$");
+#else
+    String device("/dev/stdout");
+#endif
+    if(!rawOutput.open(device, File::writeFlag | File::appendFlag))
+      return;
+  }
+  rawOutput.write(data, size);
+}
+
+void_t OutputWriter::append(const char_t* data, size_t size)
+{
+  if((size_t)(end - pos) < size)
+  {
+    flush();
+    if(size > bufferSize)
+    {
+      if(format == rawFormat)
+        writeRaw(data, size);
+      else
+        Console::print(String(data, size));
+      return;
+    }
+  }
+  Memory::copy(pos, data, size);
+  pos += size;
+}
+
+void_t OutputWriter::appendEscaped(const char_t* str, size_t length)
+{
+  // csv doubles quotes, json escapes quotes, backslashes and control characters
+  for(const char_t* strEnd = str + length; str < strEnd; ++str)
+  {
+    reserve(6);
+    char_t c = *str;
+    if(format == csvFormat)
+    {
+      if(c == '"')
+        append('"');
+      append(c);
+    }
+    else if(c == '"' || c == '\\')
+    {
+      append('\\');
+      append(c);
+    }
+    else if((uchar_t)c < 0x20)
+    {
+      static const char_t hex[] = "0123456789abcdef";
+      appendLiteral("\\u00");
+      append(hex[(uchar_t)c >> 4]);
+      append(hex[(uchar_t)c & 0xf]);
+    }
+    else
+      append(c);
+  }
+}
@@ -0,0 +1,86 @@
+
+#pragma once
+
+#include <nstd/String.h>
+#include <nstd/File.h>
+
+#include <zlimdbprotocol.h>
+
+class OutputWriter
+{
+public:
+  enum Format
+  {
+    textFormat,
+    csvFormat,
+    jsonFormat,
+    rawFormat,
+  };
+
+public:
+  OutputWriter();
+  ~OutputWriter();
+
+  void_t setFormat(Format format);
+  Format getFormat() const {return format;}
+
+  void_t writeEntity(const zlimdb_entity& entity);
+  void_t writeTable(const zlimdb_entity& entity, const char_t* name, size_t nameLength);
+
+  void_t flush();
+
+  static bool_t parseFormat(const String& name, Format& format);
+
+private:
+  enum
+  {
+    bufferSize = 256 * 1024,
+  };
+
+private:
+  Format format;
+  File rawOutput; // entities in raw format contain zero bytes, they bypass the console
+  char_t* buffer;
+  char_t* pos;
+  char_t* end;
+
+private:
+  void_t reserve(size_t size)
+  {
+    if((size_t)(end - pos) < size)
+      flush();
+  }
+
+  void_t append(const char_t* data, size_t size);
+  void_t writeRaw(const char_t* data, size_t size);
+
+  void_t append(char_t c) {*(pos++) = c;}
+
+  void_t appendUInt(uint64_t value, size_t width = 0)
+  {
+    char_t digits[20];
+    char_t* digit = digits + sizeof(digits);
+    do
+    {
+      *(--digit) = '0' + (char_t)(value % 10);
+      value /= 10;
+    } while(value);
+    size_t length = digits + sizeof(digits) - digit;
+    for(; width > length; --width)
+      *(pos++) = ' ';
+    for(; digit < digits + sizeof(digits); ++digit)
+      *(pos++) = *digit;
+  }
+
+  void_t appendLiteral(const char_t* str)
+  {
+    while(*str)
+      *(pos++) = *(str++);
+  }
+
+  void_t appendEscaped(const char_t* str, size_t length);
+
+private:
+  OutputWriter(const OutputWriter&);
+  OutputWriter& operator=(const OutputWriter&);
+};
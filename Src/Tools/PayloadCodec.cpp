@@ -0,0 +1,63 @@
+
+#include <nstd/Memory.h>
+#include <nstd/Time.h>
+
+#include <lz4.h>
+
+#include "PayloadCodec.h"
+
+const char_t PayloadCodec::lz4Magic[] = "zlz4";
+const char_t PayloadCodec::rawMagic[] = "zraw";
+
+const void_t* PayloadCodec::compress(const void_t* data, size_t size, size_t maxSize, size_t& compressedSize)
+{
+  int64_t start = Time::microTicks();
+  compressed.resize(sizeof(Header) + LZ4_compressBound((int)size));
+  Header* header = (Header*)(byte_t*)compressed;
+  header->rawSize = (uint32_t)size;
+  int result = LZ4_compress_limitedOutput((const char*)data, (char*)(header + 1), (int)size, (int)size);
+  if(result > 0)
+  {
+    Memory::copy(header->magic, lz4Magic, sizeof(header->magic));
+    compressedSize = sizeof(Header) + result;
+  }
+  else
+  {
+    // lz4 did not make it smaller, keep the payload as it is behind a marker
+    Memory::copy(header->magic, rawMagic, sizeof(header->magic));
+    Memory::copy(header + 1, data, size);
+    compressedSize = sizeof(Header) + size;
+  }
+  compressTime += Time::microTicks() - start;
+  if(compressedSize > maxSize)
+    return 0;
+  rawBytes += size;
+  encodedBytes += compressedSize;
+  return header;
+}
+
+const zlimdb_entity* PayloadCodec::decompress(const zlimdb_entity& entity)
+{
+  // payloads without a marker were added before compression was enabled and are passed through
+  if(entity.size < sizeof(zlimdb_entity) + sizeof(Header))
+    return &entity;
+  const Header* header = (const Header*)(&entity + 1);
+  size_t size = entity.size - sizeof(zlimdb_entity) - sizeof(Header);
+  bool_t lz4 = Memory::compare(header->magic, lz4Magic, sizeof(header->magic)) == 0;
+  if(!lz4 && Memory::compare(header->magic, rawMagic, sizeof(header->magic)) != 0)
+    return &entity;
+  if(sizeof(zlimdb_entity) + header->rawSize > ZLIMDB_MAX_ENTITY_SIZE || (!lz4 && header->rawSize != size))
+    return &entity;
+
+  int64_t start = Time::microTicks();
+  decompressed.resize(sizeof(zlimdb_entity) + header->rawSize);
+  zlimdb_entity* result = (zlimdb_entity*)(byte_t*)decompressed;
+  *result = entity;
+  result->size = (uint16_t)(sizeof(zlimdb_entity) + header->rawSize);
+  if(!lz4)
+    Memory::copy(result + 1, header + 1, size);
+  else if(LZ4_decompress_safe((const char*)(header + 1), (char*)(result + 1), (int)size, (int)header->rawSize) != (int)header->rawSize)
+    return &entity;
+  decompressTime += Time::microTicks() - start;
+  return result;
+}
@@ -0,0 +1,40 @@
+
+#pragma once
+
+#include <nstd/Buffer.h>
+
+#include <zlimdbprotocol.h>
+
+class PayloadCodec
+{
+public:
+  PayloadCodec() : rawBytes(0), encodedBytes(0), compressTime(0), decompressTime(0) {}
+
+  const void_t* compress(const void_t* data, size_t size, size_t maxSize, size_t& compressedSize);
+  const zlimdb_entity* decompress(const zlimdb_entity& entity);
+
+  static size_t getOverhead() {return sizeof(Header);}
+
+  uint64_t getRawBytes() const {return rawBytes;}
+  uint64_t getEncodedBytes() const {return encodedBytes;}
+  int64_t getCompressTime() const {return compressTime;}
+  int64_t getDecompressTime() const {return decompressTime;}
+
+private:
+  struct Header
+  {
+    char_t magic[4];
+    uint32_t rawSize;
+  };
+
+  static const char_t lz4Magic[];
+  static const char_t rawMagic[];
+
+private:
+  Buffer compressed;
+  Buffer decompressed;
+  uint64_t rawBytes;
+  uint64_t encodedBytes;
+  int64_t compressTime;
+  int64_t decompressTime;
+};
@@ -0,0 +1,175 @@
+
+#include "TimeMerger.h"
+
+TimeMerger::TimeMerger(uint_t inputCount, int64_t window, Handler handler, void_t* userData) :
+  window(window), handler(handler), userData(userData), maxTime(0), lastEmittedTime(0), emitted(0), late(0), bufferedBlocks(0)
+{
+  inputs.resize(inputCount);
+  for(uint_t i = 0; i < inputCount; ++i)
+  {
+    Input& input = inputs[i];
+    input.entity = 0;
+    input.end = 0;
+    input.lastTime = 0;
+    input.seen = false;
+    input.closed = false;
+  }
+  heap.reserve(inputCount);
+}
+
+TimeMerger::~TimeMerger()
+{
+  for(size_t i = 0; i < inputs.size(); ++i)
+    for(List<Buffer*>::Iterator j = inputs[i].blocks.begin(), end = inputs[i].blocks.end(); j != end; ++j)
+      delete *j;
+  for(List<Buffer*>::Iterator i = freeBlocks.begin(), end = freeBlocks.end(); i != end; ++i)
+    delete *i;
+}
+
+void_t TimeMerger::add(uint_t index, const void_t* data, size_t size)
+{
+  const byte_t* pos = (const byte_t*)data;
+  const byte_t* end = pos + size;
+  const zlimdb_entity* entity = getEntity(pos, end);
+  if(!entity)
+    return;
+
+  Buffer* block;
+  if(freeBlocks.isEmpty())
+    block = new Buffer;
+  else
+  {
+    block = freeBlocks.front();
+    freeBlocks.removeFront();
+  }
+  block->assign(pos, size);
+  Input& input = inputs[index];
+  input.blocks.append(block);
+  ++bufferedBlocks;
+
+  // the last entity of the block tells how far this input has progressed
+  const zlimdb_entity* last = entity;
+  for(const zlimdb_entity* i = entity; i; i = getEntity((const byte_t*)i + i->size, end))
+    last = i;
+  input.lastTime = last->time;
+  input.seen = true;
+  if(input.lastTime > maxTime)
+    maxTime = input.lastTime;
+
+  if(!input.entity)
+  {
+    input.entity = (const zlimdb_entity*)(const byte_t*)*block;
+    input.end = (const byte_t*)*block + size;
+    heap.append(index);
+    siftUp(heap.size() - 1);
+  }
+  emitInOrder();
+}
+
+void_t TimeMerger::close(uint_t index)
+{
+  inputs[index].closed = true;
+  emitInOrder();
+}
+
+void_t TimeMerger::advance(int64_t now)
+{
+  emit(now - window);
+}
+
+void_t TimeMerger::flush()
+{
+  emit(0x7fffffffffffffffLL);
+}
+
+void_t TimeMerger::emitInOrder()
+{
+  // entities up to the oldest progress of all inputs are in order, older ones are held back for the reorder window
+  int64_t watermark = maxTime - window;
+  int64_t progress = maxTime;
+  for(size_t i = 0; i < inputs.size(); ++i)
+    if(inputs[i].closed)
+      continue;
+    else if(!inputs[i].seen)
+      progress = watermark;
+    else if(inputs[i].lastTime < progress)
+      progress = inputs[i].lastTime;
+  emit(progress > watermark ? progress : watermark);
+}
+
+void_t TimeMerger::emit(int64_t limit)
+{
+  while(!heap.isEmpty())
+  {
+    uint_t index = heap[0];
+    Input& input = inputs[index];
+    const zlimdb_entity* entity = input.entity;
+    if((int64_t)entity->time > limit)
+      break;
+    if((int64_t)entity->time < lastEmittedTime)
+      ++late;
+    else
+      lastEmittedTime = entity->time;
+    ++emitted;
+    handler(userData, index, *entity);
+    if(next(input))
+      siftDown(0);
+    else
+    {
+      heap[0] = heap.back();
+      heap.removeBack();
+      if(!heap.isEmpty())
+        siftDown(0);
+    }
+  }
+}
+
+bool_t TimeMerger::next(Input& input)
+{
+  input.entity = getEntity((const byte_t*)input.entity + input.entity->size, input.end);
+  if(input.entity)
+    return true;
+  freeBlocks.append(input.blocks.front());
+  input.blocks.removeFront();
+  --bufferedBlocks;
+  if(input.blocks.isEmpty())
+    return false;
+  Buffer* block = input.blocks.front();
+  input.entity = (const zlimdb_entity*)(const byte_t*)*block;
+  input.end = (const byte_t*)*block + block->size();
+  return true;
+}
+
+void_t TimeMerger::siftUp(size_t index)
+{
+  while(index > 0)
+  {
+    size_t parent = (index - 1) / 2;
+    if(!isLess(heap[index], heap[parent]))
+      break;
+    uint_t tmp = heap[index];
+    heap[index] = heap[parent];
+    heap[parent] = tmp;
+    index = parent;
+  }
+}
+
+void_t TimeMerger::siftDown(size_t index)
+{
+  for(size_t size = heap.size();;)
+  {
+    size_t smallest = index;
+    size_t left = index * 2 + 1;
+    size_t right = left + 1;
+    if(left < size && isLess(heap[left], heap[smallest]))
+      smallest = left;
+    if(right < size && isLess(heap[right], heap[smallest]))
+      smallest = right;
+    if(smallest == index)
+      break;
+    uint_t tmp = heap[index];
+    heap[index] = heap[smallest];
+    heap[smallest] = tmp;
+    index = smallest;
+  }
+}
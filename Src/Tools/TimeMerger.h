@@ -0,0 +1,83 @@
+
+#pragma once
+
+#include <nstd/Buffer.h>
+#include <nstd/Array.h>
+#include <nstd/List.h>
+
+#include <zlimdbprotocol.h>
+
+// k-way merge of several time ordered entity streams: a heap holds one cursor per input, so blocks are copied
+// once when they are added and their entities are passed to the handler in place
+class TimeMerger
+{
+public:
+  typedef void_t (*Handler)(void_t* userData, uint_t input, const zlimdb_entity& entity);
+
+public:
+  TimeMerger(uint_t inputs, int64_t window, Handler handler, void_t* userData);
+  ~TimeMerger();
+
+  void_t add(uint_t input, const void_t* data, size_t size);
+  void_t close(uint_t input);
+  void_t advance(int64_t now);
+  void_t flush();
+
+  uint64_t getEmittedCount() const {return emitted;}
+  uint64_t getLateCount() const {return late;}
+  size_t getBufferedBlockCount() const {return bufferedBlocks;}
+  bool_t hasSeen(uint_t input) const {return inputs[input].seen;}
+  int64_t getInputTime(uint_t input) const {return inputs[input].lastTime;}
+
+private:
+  struct Input
+  {
+    List<Buffer*> blocks;
+    const zlimdb_entity* entity; // cursor into the front block
+    const byte_t* end;
+    int64_t lastTime;
+    bool_t seen;
+    bool_t closed; // the input ended and does not hold back the others anymore
+  };
+
+private:
+  Array<Input> inputs;
+  Array<uint_t> heap;
+  List<Buffer*> freeBlocks;
+  int64_t window;
+  Handler handler;
+  void_t* userData;
+  int64_t maxTime;
+  int64_t lastEmittedTime;
+  uint64_t emitted;
+  uint64_t late;
+  size_t bufferedBlocks;
+
+private:
+  static const zlimdb_entity* getEntity(const byte_t* pos, const byte_t* end)
+  {
+    if(pos + sizeof(zlimdb_entity) > end)
+      return 0;
+    const zlimdb_entity* entity = (const zlimdb_entity*)pos;
+    if(entity->size < sizeof(zlimdb_entity) || pos + entity->size > end)
+      return 0;
+    return entity;
+  }
+
+  bool_t isLess(uint_t a, uint_t b) const
+  {
+    const zlimdb_entity* entityA = inputs[a].entity;
+    const zlimdb_entity* entityB = inputs[b].entity;
+    return entityA->time < entityB->time || (entityA->time == entityB->time && a < b);
+  }
+
+  void_t emitInOrder();
+  void_t emit(int64_t limit);
+  bool_t next(Input& input);
+  void_t siftUp(size_t index);
+  void_t siftDown(size_t index);
+
+private:
+  TimeMerger(const TimeMerger&);
+  TimeMerger& operator=(const TimeMerger&);
+};
@@ -1,4 +1,5 @@
 
+#include "Fnv.h"
 #include "Word.h"
 
 size_t Word::split(const String& data, List<String>& result)
@@ -39,3 +40,91 @@ size_t Word::split(const String& data, List<String>& result)
   }
   return result.size();
 }
+
+size_t Word::split(const char_t* str, Word* words, size_t maxWords)
+{
+  // same rules as above, but the words are views into str, words beyond maxWords are counted only
+  size_t count = 0;
+  for(;;)
+  {
+    while(String::isSpace(*str))
+      ++str;
+    if(!*str)
+      break;
+    const char_t* end = str;
+    if(*str == _T('"'))
+    {
+      end = ++str;
+      for(; *end; ++end)
+        if(*end == _T('\\') && end[1] == _T('"'))
+          ++end;
+        else if(*end == _T('"'))
+          break;
+      if(end > str)
+      {
+        if(count < maxWords)
+        {
+          words[count].data = str;
+          words[count].length = end - str;
+        }
+        ++count;
+      }
+      str = end;
+      if(*str)
+        ++str;
+    }
+    else
+    {
+      for(; *end; ++end)
+        if(String::isSpace(*end))
+          break;
+      if(count < maxWords)
+      {
+        words[count].data = str;
+        words[count].length = end - str;
+      }
+      ++count;
+      str = end;
+    }
+  }
+  return count;
+}
+
+bool_t Word::operator==(const char_t* str) const
+{
+  for(size_t i = 0; i < length; ++i, ++str)
+    if(!*str || *str != data[i])
+      return false;
+  return !*str;
+}
+
+bool_t Word::startsWith(const char_t* prefix) const
+{
+  for(size_t i = 0; *prefix; ++i, ++prefix)
+    if(i >= length || *prefix != data[i])
+      return false;
+  return true;
+}
+
+uint64_t Word::toUInt64() const
+{
+  uint64_t result = 0;
+  for(const char_t* i = data, * end = data + length; i < end && String::isDigit(*i); ++i)
+    result = result * 10 + (*i - _T('0'));
+  return result;
+}
+
+int64_t Word::toInt64() const
+{
+  if(length && *data == _T('-'))
+  {
+    Word digits = {data + 1, length - 1};
+    return -(int64_t)digits.toUInt64();
+  }
+  return (int64_t)toUInt64();
+}
+
+size_t Word::hash(const char_t* data, size_t length)
+{
+  return (size_t)Fnv::hash(Fnv::offset, data, length);
+}
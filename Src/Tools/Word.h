@@ -7,5 +7,24 @@
 class Word
 {
 public:
+  const char_t* data; // not terminated, points into the split line
+  size_t length;
+
+public:
+  bool_t operator==(const char_t* str) const;
+  bool_t operator!=(const char_t* str) const {return !(*this == str);}
+
+  bool_t isEmpty() const {return length == 0;}
+  bool_t startsWith(const char_t* prefix) const;
+
+  String toString() const {return String(data, length);}
+  uint_t toUInt() const {return (uint_t)toUInt64();}
+  uint64_t toUInt64() const;
+  int64_t toInt64() const;
+  size_t hash() const {return hash(data, length);}
+
   static size_t split(const String& data, List<String>& result);
+  static size_t split(const char_t* data, Word* words, size_t maxWords);
+
+  static size_t hash(const char_t* data, size_t length);
 };
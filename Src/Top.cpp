@@ -0,0 +1,78 @@
+
+#include <nstd/Console.h>
+
+#include "Top.h"
+
+Top::~Top()
+{
+  for(HashMap<uint32_t, Table*>::Iterator i = tables.begin(), end = tables.end(); i != end; ++i)
+    delete *i;
+}
+
+void_t Top::addTable(uint32_t tableId, const String& name)
+{
+  if(tables.contains(tableId))
+    return;
+  Table* table = new Table;
+  table->id = tableId;
+  table->name = name;
+  table->entities = 0;
+  table->bytes = 0;
+  table->lagSum = 0;
+  table->maxLag = 0;
+  table->totalEntities = 0;
+  table->rate = 0.;
+  tables.append(tableId, table);
+  sorted.append(table);
+}
+
+void_t Top::getTableIds(Array<uint32_t>& tableIds) const
+{
+  tableIds.clear();
+  for(HashMap<uint32_t, Table*>::Iterator i = tables.begin(), end = tables.end(); i != end; ++i)
+    tableIds.append((*i)->id);
+}
+
+void_t Top::refresh(int64_t now)
+{
+  double duration = (double)(now - lastRefresh) / 1000.;
+  if(duration <= 0.)
+    duration = 0.001;
+  lastRefresh = now;
+
+  // the previous order is almost right, so an insertion sort by entity rate is cheap
+  double totalRate = 0., totalByteRate = 0.;
+  for(size_t i = 0; i < sorted.size(); ++i)
+  {
+    Table* table = sorted[i];
+    table->rate = (double)table->entities / duration;
+    totalRate += table->rate;
+    totalByteRate += (double)table->bytes / duration;
+    size_t j = i;
+    for(; j > 0 && sorted[j - 1]->rate < table->rate; --j)
+      sorted[j] = sorted[j - 1];
+    sorted[j] = table;
+  }
+
+  Console::printf("\x1b[H\x1b[2J");
+  Console::printf("top: %u tables, %.0f entities/s, %.2f MB/s\n\n", (uint_t)sorted.size(), totalRate, totalByteRate / (1024. * 1024.));
+  Console::printf("%8s %-24s %12s %12s %8s %10s %10s %12s\n", "table", "name", "entities/s", "bytes/s", "avgSize", "avgLag ms", "maxLag ms", "total");
+  for(size_t i = 0; i < sorted.size(); ++i)
+  {
+    Table* table = sorted[i];
+    table->totalEntities += table->entities;
+    if(i < maxRows)
+    {
+      uint64_t entities = table->entities;
+      Console::printf("%8u %-24.24s %12.0f %12.0f %8.0f %10.0f %10lld %12llu\n", table->id, (const char_t*)table->name, table->rate,
+        (double)table->bytes / duration, entities ? (double)table->bytes / (double)entities : 0., entities ? (double)table->lagSum / (double)entities : 0.,
+        entities ? table->maxLag : 0LL, table->totalEntities);
+    }
+    table->entities = 0;
+    table->bytes = 0;
+    table->lagSum = 0;
+    table->maxLag = 0;
+  }
+  if(sorted.size() > maxRows)
+    Console::printf("(%u more)\n", (uint_t)(sorted.size() - maxRows));
+}
@@ -0,0 +1,64 @@
+
+#pragma once
+
+#include <nstd/Array.h>
+#include <nstd/HashMap.h>
+#include <nstd/String.h>
+#include <nstd/Time.h>
+
+#include <zlimdbprotocol.h>
+
+class Top
+{
+public:
+  enum
+  {
+    refreshInterval = 1000,
+    maxRows = 30,
+  };
+
+public:
+  Top() : lastRefresh(0) {}
+  ~Top();
+
+  void_t addTable(uint32_t tableId, const String& name);
+  bool_t isEmpty() const {return tables.isEmpty();}
+  void_t getTableIds(Array<uint32_t>& tableIds) const;
+
+  bool_t add(uint32_t tableId, const zlimdb_entity& entity)
+  {
+    HashMap<uint32_t, Table*>::Iterator it = tables.find(tableId);
+    if(it == tables.end())
+      return false;
+    Table* table = *it;
+    int64_t lag = Time::time() - (int64_t)entity.time;
+    ++table->entities;
+    table->bytes += entity.size;
+    table->lagSum += lag;
+    if(lag > table->maxLag)
+      table->maxLag = lag;
+    return true;
+  }
+
+  void_t start(int64_t now) {lastRefresh = now;}
+  int64_t getNextRefresh() const {return lastRefresh + refreshInterval;}
+  void_t refresh(int64_t now);
+
+private:
+  struct Table
+  {
+    uint32_t id;
+    String name;
+    uint64_t entities; // counters since the last refresh
+    uint64_t bytes;
+    int64_t lagSum;
+    int64_t maxLag;
+    uint64_t totalEntities;
+    double rate;
+  };
+
+private:
+  HashMap<uint32_t, Table*> tables;
+  Array<Table*> sorted;
+  int64_t lastRefresh;
+};
@@ -0,0 +1,164 @@
+#!/bin/sh
+
+# Runs each Test/*.script against a fresh zlimdbloopback server and checks the output of the client.
+# Lines starting with "#expect <regex>" or "#reject <regex>" in a script must or must not match the output,
+# "@DIR@" is replaced with a directory holding the generated input files, any "error:" line fails the script unless it
+# matches a "#allow <regex>" line. A "#restart <regex>" line waits for the regex in the output, restarts the server and
+# feeds the rest of the script once the client has reconnected.
+#
+# usage: Test/run.sh [<zlimdbclient> [<zlimdbloopback>]]
+
+root=$(cd "$(dirname "$0")/.." && pwd)
+client=${1:-$root/Build/Debug/zlimdbclient/zlimdbclient}
+loopback=${2:-$root/Build/Debug/zlimdbloopback/zlimdbloopback}
+address=${ZLIMDB_TEST_ADDRESS:-127.0.0.1:13299}
+
+for binary in "$client" "$loopback"; do
+  if [ ! -x "$binary" ]; then
+    echo "error: Could not find $binary" >&2
+    exit 1
+  fi
+done
+
+dir=$(mktemp -d)
+server=
+session=
+trap 'test -n "$server" && kill $server 2>/dev/null; test -n "$session" && kill $session 2>/dev/null; rm -rf "$dir"' EXIT
+
+# retries a command every 0.1 s until it succeeds, for at most 10 s
+await()
+{
+  tries=0
+  until "$@"; do
+    tries=$((tries + 1))
+    if [ $tries -gt 100 ]; then
+      return 1
+    fi
+    sleep 0.1
+  done
+}
+
+started()
+{
+  kill -0 $server 2>/dev/null && grep -q "^listening on" "$dir/$name.server"
+}
+
+reconnected()
+{
+  [ "$(grep -ac "^reconnected to" "$dir/$name.out")" -ge $1 ]
+}
+
+startServer()
+{
+  "$loopback" "$address" < /dev/null > "$dir/$name.server" 2>&1 3>&- &
+  server=$!
+  if ! await started; then
+    echo "error: Could not start $loopback on $address" >&2
+    cat "$dir/$name.server" >&2
+    exit 1
+  fi
+}
+
+stopServer()
+{
+  kill $server 2>/dev/null
+  wait $server 2>/dev/null
+  server=
+}
+
+# records are padded, so that compression has something to gain
+padding=$(printf '%0120d' 0 | tr 0 x)
+i=1
+while [ $i -le 1000 ]; do
+  printf 'record-%04d %s\n' $i "$padding"
+  i=$((i + 1))
+done > "$dir/records.txt"
+printf 'record-1001 extra\nrecord-1002 extra\n' > "$dir/extra.txt"
+
+failed=0
+for script in "$root"/Test/*.script; do
+  name=$(basename "$script" .script)
+  rm -f "$dir"/*.export
+  sed "s|@DIR@|$dir|g" "$script" > "$dir/$name.script"
+
+  startServer
+  problems=
+  if grep -q "^#restart " "$script"; then
+    # the script is fed through a pipe, so that the server can be restarted in between
+    rm -f "$dir/input"
+    mkfifo "$dir/input"
+    "$client" --script - "$address" < "$dir/input" > "$dir/$name.out" 2>&1 &
+    session=$!
+    exec 3> "$dir/input"
+    restarts=0
+    while IFS= read -r line; do
+      case "$line" in
+      "#restart "*)
+        restarts=$((restarts + 1))
+        if ! await grep -aqE -- "${line#\#restart }" "$dir/$name.out"; then
+          problems="$problems
+  missing before restart: ${line#\#restart }"
+          break
+        fi
+        stopServer
+        startServer
+        if ! await reconnected $restarts; then
+          problems="$problems
+  no reconnect after restart $restarts"
+          break
+        fi
+        ;;
+      *)
+        printf '%s\n' "$line" >&3
+        ;;
+      esac
+    done < "$dir/$name.script"
+    exec 3>&-
+    if [ -n "$problems" ]; then
+      kill $session 2>/dev/null
+    fi
+    wait $session
+    result=$?
+    session=
+  else
+    "$client" --script "$dir/$name.script" "$address" > "$dir/$name.out" 2>&1
+    result=$?
+  fi
+  stopServer
+
+  if [ $result -ne 0 ]; then
+    problems="$problems
+  exit code $result"
+  fi
+  allowed=$(sed -n 's/^#allow //p' "$script" | paste -sd '|' -)
+  if grep -a "error:" "$dir/$name.out" | grep -avqE -- "${allowed:-^$}"; then
+    problems="$problems
+  unexpected error output"
+  fi
+  while read -r directive pattern; do
+    case "$directive" in
+    "#expect")
+      grep -aqE -- "$pattern" "$dir/$name.out" || problems="$problems
+  missing: $pattern"
+      ;;
+    "#reject")
+      grep -aqE -- "$pattern" "$dir/$name.out" && problems="$problems
+  unexpected: $pattern"
+      ;;
+    esac
+  done < "$script"
+
+  if [ -z "$problems" ]; then
+    echo "passed $name"
+  else
+    echo "failed $name:$problems"
+    sed 's/^/  | /' "$dir/$name.out" | tr -c '[:print:]\n' '.'
+    failed=$((failed + 1))
+  fi
+done
+
+if [ $failed -ne 0 ]; then
+  echo "$failed failed"
+  exit 1
+fi
+exit 0